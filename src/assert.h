@@ -1,7 +1,9 @@
 #ifndef ASSERT_H
 #define ASSERT_H
 
+#ifndef NDEBUG
 #define NDEBUG
+#endif
 
 #include <assert.h>
 
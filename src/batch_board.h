@@ -0,0 +1,214 @@
+#ifndef BATCH_BOARD_H
+#define BATCH_BOARD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "bitboard.h"
+#include "board.h"
+#include "piece.h"
+#include "player.h"
+
+#if defined(__GNUC__)
+#define BATCH_VECTOR_EXTENSIONS 1
+#else
+#define BATCH_VECTOR_EXTENSIONS 0
+#endif
+
+#if BATCH_VECTOR_EXTENSIONS
+template <size_t Lanes> struct LaneVector;
+
+template <> struct LaneVector<4> {
+  typedef uint64_t type __attribute__((vector_size(32)));
+};
+
+template <> struct LaneVector<8> {
+  typedef uint64_t type __attribute__((vector_size(64)));
+};
+#else
+// Stand in for the GCC and Clang vector types, looping over the lanes with a
+// trip count known at compile time for the compiler to vectorize.
+template <size_t Lanes> struct LaneArray {
+  alignas(Lanes * sizeof(uint64_t)) uint64_t lanes[Lanes];
+
+  uint64_t &operator[](size_t lane) { return lanes[lane]; }
+  uint64_t operator[](size_t lane) const { return lanes[lane]; }
+
+  template <class F> friend LaneArray lanewise(LaneArray bits, F f) {
+    for (size_t i = 0; i < Lanes; ++i) {
+      bits.lanes[i] = f(bits.lanes[i]);
+    }
+    return bits;
+  }
+
+  template <class F>
+  friend LaneArray lanewise(LaneArray first, const LaneArray &second, F f) {
+    for (size_t i = 0; i < Lanes; ++i) {
+      first.lanes[i] = f(first.lanes[i], second.lanes[i]);
+    }
+    return first;
+  }
+
+  friend LaneArray operator&(LaneArray first, const LaneArray &second) {
+    return lanewise(first, second, [](uint64_t a, uint64_t b) { return a & b; });
+  }
+  friend LaneArray operator|(LaneArray first, const LaneArray &second) {
+    return lanewise(first, second, [](uint64_t a, uint64_t b) { return a | b; });
+  }
+  friend LaneArray operator^(LaneArray first, const LaneArray &second) {
+    return lanewise(first, second, [](uint64_t a, uint64_t b) { return a ^ b; });
+  }
+  friend LaneArray operator&(LaneArray first, uint64_t second) {
+    return lanewise(first, [second](uint64_t a) { return a & second; });
+  }
+  friend LaneArray operator-(LaneArray bits) {
+    return lanewise(bits, [](uint64_t a) { return 0ull - a; });
+  }
+  friend LaneArray operator~(LaneArray bits) {
+    return lanewise(bits, [](uint64_t a) { return ~a; });
+  }
+  friend LaneArray operator<<(LaneArray bits, int count) {
+    return lanewise(bits, [count](uint64_t a) { return a << count; });
+  }
+  friend LaneArray operator>>(LaneArray bits, int count) {
+    return lanewise(bits, [count](uint64_t a) { return a >> count; });
+  }
+};
+#endif
+
+// One bitboard per position of a batch. With GCC and Clang the lanes are a
+// native vector, which stays in SIMD registers across the operators and the
+// fills built from them: SSE2 by default, AVX2 over 4 lanes with -mavx2.
+template <size_t Lanes> struct BatchMask {
+  static_assert(Lanes == 4 || Lanes == 8, "Batches hold 4 or 8 positions");
+
+#if BATCH_VECTOR_EXTENSIONS
+  using Vector = typename LaneVector<Lanes>::type;
+#else
+  using Vector = LaneArray<Lanes>;
+#endif
+
+  Vector lanes;
+
+  uint64_t operator[](size_t lane) const { return lanes[lane]; }
+
+  bool any() const {
+    uint64_t bits = 0ull;
+    for (size_t i = 0; i < Lanes; ++i) {
+      bits |= lanes[i];
+    }
+    return bits != 0ull;
+  }
+
+  // The least significant bit of every lane.
+  BatchMask lsb() const { return {lanes & -lanes}; }
+
+  // All ones in the lanes that are not empty.
+  BatchMask nonzero() const {
+#if BATCH_VECTOR_EXTENSIONS
+    return {(Vector)(lanes != 0)};
+#else
+    return {lanewise(lanes, [](uint64_t a) { return a ? ~0ull : 0ull; })};
+#endif
+  }
+
+  BatchMask operator~() const { return {~lanes}; }
+  BatchMask operator<<(int count) const { return {lanes << count}; }
+  BatchMask operator>>(int count) const { return {lanes >> count}; }
+
+  BatchMask &operator&=(const BatchMask &other) {
+    lanes = lanes & other.lanes;
+    return *this;
+  }
+
+  BatchMask &operator|=(const BatchMask &other) {
+    lanes = lanes | other.lanes;
+    return *this;
+  }
+
+  BatchMask &operator^=(const BatchMask &other) {
+    lanes = lanes ^ other.lanes;
+    return *this;
+  }
+
+  BatchMask &operator&=(uint64_t bits) {
+    lanes = lanes & bits;
+    return *this;
+  }
+
+  friend BatchMask operator&(BatchMask first, const BatchMask &second) {
+    return first &= second;
+  }
+
+  friend BatchMask operator|(BatchMask first, const BatchMask &second) {
+    return first |= second;
+  }
+
+  friend BatchMask operator^(BatchMask first, const BatchMask &second) {
+    return first ^= second;
+  }
+
+  friend BatchMask operator&(BatchMask first, uint64_t second) {
+    return first &= second;
+  }
+};
+
+// Up to Lanes positions in structure of arrays layout, so the same bitboard
+// of every position is contiguous. Each position is stored from the side to
+// move's point of view: black to move positions are mirrored vertically and
+// their colours swapped, so the batch generator only handles white to move.
+// Unused lanes are empty and generate no moves.
+template <size_t Lanes> struct BatchBoard {
+  static constexpr size_t lanes = Lanes;
+
+  // Side 0 is the side to move, side 1 the opponent. Piece::none holds the
+  // occupancy of the side.
+  std::array<std::array<BatchMask<Lanes>, Piece::count>, 2> pieces{};
+  // All ones in the lanes that were mirrored.
+  BatchMask<Lanes> flipped{};
+  // En passant target square after mirroring, 0 if there is none.
+  std::array<int, Lanes> en_passant{};
+  // Castle rights of the side to move, bit 1 kingside and bit 2 queenside.
+  std::array<unsigned, Lanes> castle_rights{};
+  size_t size = 0;
+
+  template <Piece P> const BatchMask<Lanes> &get(int side) const {
+    return pieces[side][P];
+  }
+
+  const BatchMask<Lanes> &get_occupied_mask(int side) const {
+    return pieces[side][Piece::none];
+  }
+
+  bool full() const { return size == Lanes; }
+
+  void clear() { *this = BatchBoard(); }
+
+  // Copy board into the next free lane.
+  void push(const Board &board) {
+    ASSERT(size < Lanes, size, "Attempting to push to a full batch.");
+    const size_t lane = size++;
+    const bool flip = board.player == Player::black;
+    auto relative = [flip](uint64_t bits) {
+      return flip ? bitboard::flip_vertical(bits) : bits;
+    };
+    const int own = static_cast<int>(board.player);
+    const int enemy = static_cast<int>(!board.player);
+    for (int piece = Piece::pawn; piece < Piece::count; ++piece) {
+      pieces[0][piece].lanes[lane] =
+          relative(board.pieces[piece] & board.occupancy[own]);
+      pieces[1][piece].lanes[lane] =
+          relative(board.pieces[piece] & board.occupancy[enemy]);
+    }
+    pieces[0][Piece::none].lanes[lane] = relative(board.occupancy[own]);
+    pieces[1][Piece::none].lanes[lane] = relative(board.occupancy[enemy]);
+    flipped.lanes[lane] = flip ? ~0ull : 0ull;
+    en_passant[lane] =
+        board.en_passant != 0 && flip ? board.en_passant ^ 56 : board.en_passant;
+    castle_rights[lane] =
+        flip ? board.castle_rights >> 2 & 3u : board.castle_rights & 3u;
+  }
+};
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef BATCH_MOVE_LIST_H
+#define BATCH_MOVE_LIST_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "batch_board.h"
+#include "bitboard.h"
+#include "move.h"
+#include "move_generator.h"
+#include "move_serialize.h"
+#include "slider_attacks.h"
+#include "slider_fill.h"
+
+// Attacks of every piece of a set at once, so they work on the lanes of a
+// batch as well as on a single bitboard.
+template <class Bits> Bits knight_attacks_of(const Bits &knights) {
+  return (knights & ~(bitboard::a_file | bitboard::b_file)) << 10 |
+         (knights & ~(bitboard::g_file | bitboard::h_file)) >> 10 |
+         (knights & ~(bitboard::a_file | bitboard::b_file)) >> 6 |
+         (knights & ~(bitboard::g_file | bitboard::h_file)) << 6 |
+         (knights & ~bitboard::a_file) >> 15 |
+         (knights & ~bitboard::a_file) << 17 |
+         (knights & ~bitboard::h_file) << 15 |
+         (knights & ~bitboard::h_file) >> 17;
+}
+
+template <class Bits> Bits king_attacks_of(const Bits &kings) {
+  const Bits row = kings | (kings & ~bitboard::a_file) << 1 |
+                   (kings & ~bitboard::h_file) >> 1;
+  return (row | row << 8 | row >> 8) ^ kings;
+}
+
+// Legal moves of every position of a BatchBoard. Everything up to the
+// destination masks runs on all lanes at once with the same instructions:
+// the enemy attacks, checkers and pins come from Kogge-Stone fills of the
+// enemy sliders and of the king moving as a queen, and the pieces of each
+// kind are taken one per lane per round, so a round costs the same whatever
+// the positions look like. Only writing the moves and the rare en passant
+// and castling checks are done lane by lane.
+//
+// The moves of a lane are the same as MoveList's, in a different order.
+template <size_t Lanes> class BatchMoveList {
+private:
+  using Mask = BatchMask<Lanes>;
+
+  // Room for the most moves of a position plus the 7 move overrun of
+  // serialize_moves.
+  std::array<std::array<Move, 256>, Lanes> _move_list;
+  std::array<size_t, Lanes> _size{};
+  const BatchBoard<Lanes> &_batch;
+  Mask _empty;
+  // Squares a move of the side to move may end on: not its own pieces and,
+  // in check, the checker or a square blocking it.
+  Mask _target;
+  // Pieces pinned along each line through the king, indexed by the Ray on
+  // either side of it modulo 4, and the squares they may move to.
+  Mask _pinned[ray_count / 2] = {};
+  Mask _pin_rays[ray_count / 2] = {};
+
+  template <class F, int... Rays>
+  static void for_each_ray(F f, std::integer_sequence<int, Rays...>) {
+    (f(std::integral_constant<int, Rays>{}), ...);
+  }
+
+  template <class F> static void for_each_ray(F f) {
+    for_each_ray(f, std::make_integer_sequence<int, ray_count>{});
+  }
+
+  static constexpr bool is_diagonal(int ray) {
+    return ray % (ray_count / 2) >= 2;
+  }
+
+  // Write the moves from each lane's square in from to its squares in to.
+  // Squares are as stored in the batch until the constructor mirrors the
+  // black to move lanes back at the end.
+  void push_moves(const Mask &from, const Mask &to) {
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      if (from[lane] == 0u) {
+        continue;
+      }
+      Move *moves = _move_list[lane].data();
+      _size[lane] =
+          serialize_moves(moves + _size[lane], bitboard::get_lsb(from[lane]),
+                          to[lane]) -
+          moves;
+    }
+  }
+
+  // Write the pawn moves to the squares in to from delta squares behind.
+  void push_pawn_moves(const Mask &to, int delta) {
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      if (to[lane] == 0u) {
+        continue;
+      }
+      Move *moves = _move_list[lane].data();
+      size_t &size = _size[lane];
+      uint64_t promotions = to[lane] & bitboard::rank_8;
+      while (promotions) {
+        int to_square = bitboard::pop_lsb(promotions);
+        int from_square = to_square - delta;
+        for (MoveType type :
+             {MoveType::queen_promotion, MoveType::knight_promotion,
+              MoveType::rook_promotion, MoveType::bishop_promotion}) {
+          moves[size++] = Move(from_square, to_square, type);
+        }
+      }
+      size = serialize_pawn_moves(moves + size, delta,
+                                  to[lane] & ~bitboard::rank_8,
+                                  delta == 16 ? MoveType::double_push
+                                              : MoveType::normal) -
+             moves;
+    }
+  }
+
+  // Squares the pieces in each lane of pieces may move to when pinned: the
+  // pin ray of their line if they are pinned, everything otherwise.
+  template <int First, int Second>
+  Mask pin_restriction(const Mask &pieces) const {
+    const Mask pinned = pieces & (_pinned[First] | _pinned[Second]);
+    return ~pinned.nonzero() |
+           ((pieces & _pinned[First]).nonzero() & _pin_rays[First]) |
+           ((pieces & _pinned[Second]).nonzero() & _pin_rays[Second]);
+  }
+
+  // Moves of the pieces that move along the rays of one kind, one piece per
+  // lane per round. Pieces pinned along the other kind of line cannot move.
+  template <bool Diagonal> void push_slider_moves(Mask movers) {
+    constexpr int first = Diagonal ? 2 : 0;
+    constexpr int second = Diagonal ? 3 : 1;
+    movers &= ~(_pinned[first ^ 2] | _pinned[second ^ 2]);
+    while (movers.any()) {
+      const Mask piece = movers.lsb();
+      movers ^= piece;
+      Mask attacks{};
+      for_each_ray([&](auto ray) {
+        if constexpr (is_diagonal(decltype(ray)::value) == Diagonal) {
+          attacks |= ray_fill<decltype(ray)::value>(piece, _empty);
+        }
+      });
+      push_moves(piece,
+                 attacks & _target & pin_restriction<first, second>(piece));
+    }
+  }
+
+  void push_knight_moves(Mask knights) {
+    knights &= ~(_pinned[0] | _pinned[1] | _pinned[2] | _pinned[3]);
+    while (knights.any()) {
+      const Mask knight = knights.lsb();
+      knights ^= knight;
+      push_moves(knight, knight_attacks_of(knight) & _target);
+    }
+  }
+
+  void push_pawn_moves(const Mask &pawns, const Mask &enemy) {
+    const Mask pinned = _pinned[0] | _pinned[1] | _pinned[2] | _pinned[3];
+    // Pinned pawns move only along the line of the pin.
+    const Mask pushers = pawns & ~(pinned & ~_pinned[0]);
+    const Mask single = pushers << 8 & _empty;
+    push_pawn_moves(single & _target, 8);
+    push_pawn_moves((single & bitboard::rank_3) << 8 & _empty & _target, 16);
+    const Mask left = pawns & ~(pinned & ~_pinned[2]);
+    push_pawn_moves((left & ~bitboard::a_file) << 9 & enemy & _target, 9);
+    const Mask right = pawns & ~(pinned & ~_pinned[3]);
+    push_pawn_moves((right & ~bitboard::h_file) << 7 & enemy & _target, 7);
+  }
+
+  // En passant captures are checked for legality one by one against the
+  // board after the capture, which also catches the pawns leaving the rank
+  // of the king.
+  void push_en_passant(size_t lane) {
+    const int en_passant = _batch.en_passant[lane];
+    if (en_passant == 0) {
+      return;
+    }
+    const uint64_t captured = bitboard::to_bitboard(en_passant - 8);
+    const uint64_t target = bitboard::to_bitboard(en_passant);
+    uint64_t attackers = ((target & ~bitboard::h_file) >> 9 |
+                          (target & ~bitboard::a_file) >> 7) &
+                         _batch.template get<Piece::pawn>(0)[lane];
+    const int king_square =
+        bitboard::get_lsb(_batch.template get<Piece::king>(0)[lane]);
+    const uint64_t enemy_queens = _batch.template get<Piece::queen>(1)[lane];
+    const uint64_t enemy_diagonal =
+        _batch.template get<Piece::bishop>(1)[lane] | enemy_queens;
+    const uint64_t enemy_orthogonal =
+        _batch.template get<Piece::rook>(1)[lane] | enemy_queens;
+    const uint64_t enemy_contact =
+        (pseudo_knight_moves(king_square) &
+         _batch.template get<Piece::knight>(1)[lane]) |
+        (pawn_attacks(Player::white, king_square) &
+         _batch.template get<Piece::pawn>(1)[lane] & ~captured);
+    while (attackers) {
+      const int from = bitboard::pop_lsb(attackers);
+      const uint64_t occupancy =
+          ~_empty[lane] ^ bitboard::to_bitboard(from) ^ captured ^ target;
+      if (enemy_contact ||
+          (bishop_lookup(king_square, occupancy) & enemy_diagonal) ||
+          (rook_lookup(king_square, occupancy) & enemy_orthogonal)) {
+        continue;
+      }
+      _move_list[lane][_size[lane]++] =
+          Move(from, en_passant, MoveType::en_passant);
+    }
+  }
+
+  void push_castle_moves(size_t lane, uint64_t attacks) {
+    const unsigned rights = _batch.castle_rights[lane];
+    if (rights == 0u) {
+      return;
+    }
+    const uint64_t occupancy = ~_empty[lane];
+    const int king_square =
+        bitboard::get_lsb(_batch.template get<Piece::king>(0)[lane]);
+    if ((rights & 1u) &&
+        !(bitboard::between_horizonal(king_square, king_square - 3) &
+          (occupancy | attacks))) {
+      _move_list[lane][_size[lane]++] =
+          Move(king_square, king_square - 2, MoveType::castle);
+    }
+    if ((rights & 2u) &&
+        !(bitboard::between_horizonal(king_square, king_square + 4) &
+          occupancy) &&
+        !(bitboard::between_horizonal(king_square, king_square + 3) &
+          attacks)) {
+      _move_list[lane][_size[lane]++] =
+          Move(king_square, king_square + 2, MoveType::castle);
+    }
+  }
+
+public:
+  explicit BatchMoveList(const BatchBoard<Lanes> &batch) : _batch(batch) {
+    const Mask &own = batch.get_occupied_mask(0);
+    const Mask &enemy = batch.get_occupied_mask(1);
+    const Mask &king = batch.template get<Piece::king>(0);
+    _empty = ~(own | enemy);
+
+    const Mask enemy_diagonal = batch.template get<Piece::bishop>(1) |
+                                batch.template get<Piece::queen>(1);
+    const Mask enemy_orthogonal = batch.template get<Piece::rook>(1) |
+                                  batch.template get<Piece::queen>(1);
+
+    // Rays of the enemy sliders and of the king moving as a queen.
+    Mask slider_rays[ray_count];
+    Mask king_rays[ray_count];
+    for_each_ray([&](auto ray) {
+      constexpr int r = decltype(ray)::value;
+      slider_rays[r] = ray_fill<r>(
+          is_diagonal(r) ? enemy_diagonal : enemy_orthogonal, _empty);
+      king_rays[r] = ray_fill<r>(king, _empty);
+    });
+
+    // A slider ray reaching the king continues behind it, where the king
+    // cannot step either.
+    Mask attacks = knight_attacks_of(batch.template get<Piece::knight>(1)) |
+                   king_attacks_of(batch.template get<Piece::king>(1));
+    const Mask &enemy_pawns = batch.template get<Piece::pawn>(1);
+    attacks |= (enemy_pawns & ~bitboard::h_file) >> 9 |
+               (enemy_pawns & ~bitboard::a_file) >> 7;
+    Mask checkers = knight_attacks_of(king) &
+                    batch.template get<Piece::knight>(1);
+    checkers |= ((king & ~bitboard::h_file) << 7 |
+                 (king & ~bitboard::a_file) << 9) &
+                enemy_pawns;
+    Mask block{};
+    for_each_ray([&](auto ray) {
+      constexpr int r = decltype(ray)::value;
+      constexpr int opposite = (r + ray_count / 2) % ray_count;
+      attacks |= slider_rays[r] | ray_step<r>(slider_rays[r] & king);
+      checkers |= king_rays[r] &
+                  (is_diagonal(r) ? enemy_diagonal : enemy_orthogonal);
+      // The king ray and the opposite slider ray meet on the empty squares
+      // between a checker and the king, or on the one piece between a
+      // pinner and the king.
+      const Mask meet = king_rays[r] & slider_rays[opposite];
+      block |= meet & _empty;
+      const Mask pinned = meet & own;
+      if (pinned.any()) {
+        _pinned[r % (ray_count / 2)] |= pinned;
+        _pin_rays[r % (ray_count / 2)] |=
+            king_rays[r] | ray_fill<r>(pinned, _empty);
+      }
+    });
+
+    // Out of check every square is a target, in single check the checker
+    // and the blocking squares, in double check only the king moves.
+    const Mask in_check = checkers.nonzero();
+    _target = ~own & (~in_check | checkers | block) &
+              ~(checkers ^ checkers.lsb()).nonzero();
+
+    push_moves(king, king_attacks_of(king) & ~own & ~attacks);
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      if (in_check[lane] == 0u) {
+        push_castle_moves(lane, attacks[lane]);
+      }
+    }
+    push_pawn_moves(batch.template get<Piece::pawn>(0), enemy);
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      if (_target[lane] != 0u) {
+        push_en_passant(lane);
+      }
+    }
+    push_knight_moves(batch.template get<Piece::knight>(0));
+    push_slider_moves<true>(batch.template get<Piece::bishop>(0) |
+                            batch.template get<Piece::queen>(0));
+    push_slider_moves<false>(batch.template get<Piece::rook>(0) |
+                             batch.template get<Piece::queen>(0));
+
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+      if (batch.flipped[lane] != 0u) {
+        // Mirror the from and to squares.
+        for (size_t i = 0; i < _size[lane]; ++i) {
+          _move_list[lane][i].data ^= 56 | 56 << 6;
+        }
+      }
+    }
+  }
+
+  size_t size(size_t lane) const { return _size[lane]; }
+
+  const Move *begin(size_t lane) const { return _move_list[lane].data(); }
+
+  const Move *end(size_t lane) const {
+    return _move_list[lane].data() + _size[lane];
+  }
+};
+
+#endif
@@ -1,9 +1,13 @@
 #ifndef BITBOARD_H
 #define BITBOARD_H
 
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <nmmintrin.h>
 #include <string>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #include "assert.h"
 #include "magic_moves.h"
@@ -28,9 +32,72 @@ namespace bitboard
     constexpr uint64_t rank_7 = 0x00ff000000000000;
     constexpr uint64_t rank_8 = 0xff00000000000000;
 
-    extern uint64_t rook_attacks[64];
-    extern uint64_t bishop_attacks[64];
-    extern uint64_t between_mask[64][64];
+    constexpr int rook_directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    constexpr int bishop_directions[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+    // Attacks of a slider walking the (rank, file) directions from square, each
+    // ray stopping at the first square set in occupancy. Slow, but usable in
+    // constant expressions to generate the tables below.
+    constexpr uint64_t sliding_attacks(int square, uint64_t occupancy, const int (&directions)[4][2])
+    {
+        uint64_t attacks = 0ull;
+        for (const auto& direction : directions)
+        {
+            int rank = square / 8 + direction[0];
+            int file = square % 8 + direction[1];
+            while (rank >= 0 && rank < 8 && file >= 0 && file < 8)
+            {
+                uint64_t bit = 1ull << (rank * 8 + file);
+                attacks |= bit;
+                if (occupancy & bit)
+                {
+                    break;
+                }
+                rank += direction[0];
+                file += direction[1];
+            }
+        }
+        return attacks;
+    }
+
+    constexpr std::array<uint64_t, 64> empty_board_attacks(const int (&directions)[4][2])
+    {
+        std::array<uint64_t, 64> attacks{};
+        for (int square = 0; square < 64; ++square)
+        {
+            attacks[square] = sliding_attacks(square, 0ull, directions);
+        }
+        return attacks;
+    }
+
+    // The squares strictly between two squares on a line, 0 if they do not share
+    // one. The rook and bishop rays are intersected separately - two squares on
+    // the same rank may share diagonal squares and vice versa.
+    constexpr std::array<std::array<uint64_t, 64>, 64> create_between_mask()
+    {
+        std::array<std::array<uint64_t, 64>, 64> between{};
+        for (int i = 0; i < 64; ++i)
+        {
+            for (int j = 0; j < 64; ++j)
+            {
+                uint64_t occupancy = 1ull << i | 1ull << j;
+                for (const auto* directions : { &rook_directions, &bishop_directions })
+                {
+                    if (sliding_attacks(i, 0ull, *directions) & 1ull << j)
+                    {
+                        between[i][j] |= sliding_attacks(i, occupancy, *directions) & sliding_attacks(j, occupancy, *directions);
+                    }
+                }
+            }
+        }
+        return between;
+    }
+
+    // Generated at compile time, so they are read only data shared between
+    // processes and need no initialization.
+    inline constexpr std::array<uint64_t, 64> rook_attacks = empty_board_attacks(rook_directions);
+    inline constexpr std::array<uint64_t, 64> bishop_attacks = empty_board_attacks(bishop_directions);
+    inline constexpr std::array<std::array<uint64_t, 64>, 64> between_mask = create_between_mask();
 
     uint64_t between_horizonal(int square0, int square1);
     uint64_t between_diagonal(int square0, int square1);
@@ -39,29 +106,52 @@ namespace bitboard
     uint64_t bishop_moves(int square);
     uint64_t rook_moves(int square);
 
+    // Single instructions on 64-bit targets: tzcnt or bsf, blsr with BMI1 and
+    // popcnt with POPCNT. Without those extensions the compiler falls back to
+    // bsf, a subtract and and, and a bit counting routine. 32-bit MSVC builds
+    // work on the two halves.
     inline int get_lsb(uint64_t bitboard)
     {
         ASSERT(bitboard, bitboard, "Attempting to get_lsb of 0.");
+#if defined(_MSC_VER) && defined(_WIN64)
+        unsigned long index;
+        _BitScanForward64(&index, bitboard);
+        return static_cast<int>(index);
+#elif defined(_MSC_VER)
         unsigned long index;
         if (_BitScanForward(&index, static_cast<unsigned long>(bitboard)))
         {
             return static_cast<int>(index);
         }
-        _BitScanForward(&index, bitboard >> 32);
+        _BitScanForward(&index, static_cast<unsigned long>(bitboard >> 32));
         return static_cast<int>(index) + 32;
+#else
+        return __builtin_ctzll(bitboard);
+#endif
+    }
+
+    inline uint64_t clear_lsb(uint64_t bitboard)
+    {
+        return bitboard & (bitboard - 1);
     }
 
     inline int pop_lsb(uint64_t& bitboard)
     {
         ASSERT(bitboard, bitboard, "Attempting to pop_lsb of 0.");
         int lsb = get_lsb(bitboard);
-        bitboard &= bitboard - 1;
+        bitboard = clear_lsb(bitboard);
         return lsb;
     }
 
     inline int pop_count(uint64_t bitboard)
     {
-        return _mm_popcnt_u32(static_cast<unsigned int>(bitboard)) + _mm_popcnt_u32(static_cast<unsigned int>(bitboard >> 32));
+#if defined(_MSC_VER) && defined(_WIN64)
+        return static_cast<int>(__popcnt64(bitboard));
+#elif defined(_MSC_VER)
+        return static_cast<int>(__popcnt(static_cast<unsigned int>(bitboard)) + __popcnt(static_cast<unsigned int>(bitboard >> 32)));
+#else
+        return __builtin_popcountll(bitboard);
+#endif
     }
 
     inline int get_rank(uint64_t bitboard)
@@ -77,6 +167,15 @@ namespace bitboard
         return 1ull << square;
     }
 
+    // Mirror the ranks, so square s moves to s ^ 56 and black's pieces can be
+    // treated as white's.
+    constexpr uint64_t flip_vertical(uint64_t bitboard)
+    {
+        bitboard = (bitboard >> 8 & 0x00ff00ff00ff00ffull) | (bitboard & 0x00ff00ff00ff00ffull) << 8;
+        bitboard = (bitboard >> 16 & 0x0000ffff0000ffffull) | (bitboard & 0x0000ffff0000ffffull) << 16;
+        return bitboard >> 32 | bitboard << 32;
+    }
+
     template<class... Args>
     inline uint64_t to_bitboard(Args... args) {
         return (to_bitboard(args) | ...);
@@ -103,8 +202,6 @@ namespace bitboard
         }
     }
 
-    void init();
-
 }
 
 #endif
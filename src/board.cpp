@@ -2,11 +2,6 @@
 #include "hash.h"
 #include "move_generator.h"
 
-constexpr unsigned kingside_castle_white = 1;
-constexpr unsigned queenside_castle_white = 2;
-constexpr unsigned kingside_castle_black = 4;
-constexpr unsigned queenside_castle_black = 8;
-
 Board::Board() {
   player = Player::white;
   pieces.fill({});
@@ -57,7 +52,7 @@ void Board::remove_piece(Player player, int square) {
 }
 
 template <Player Stm> uint64_t Board::get_occupied_mask() const noexcept {
-  return std::get<Stm>(occupancy);
+  return std::get<static_cast<int>(Stm)>(occupancy);
 }
 
 template uint64_t Board::get_occupied_mask<Player::white>() const noexcept;
@@ -76,8 +71,8 @@ template <Player Stm>
 uint64_t Board::get_attack_mask(uint64_t occupancy) const {
   MoveGen<Stm> gen(occupancy);
   uint64_t attacks =
-      gen.attacks_by<Piece::pawn>(get_piece_mask<Stm, Piece::pawn>()) |
-      gen.attacks_by<Piece::knight>(get_piece_mask<Stm, Piece::knight>());
+      gen.template attacks_by<Piece::pawn>(get_piece_mask<Stm, Piece::pawn>()) |
+      gen.template attacks_by<Piece::knight>(get_piece_mask<Stm, Piece::knight>());
   int square = get_king_square<!Stm>();
   uint64_t king_mask = pseudo_king_moves(square);
 
@@ -87,7 +82,7 @@ uint64_t Board::get_attack_mask(uint64_t occupancy) const {
   while (d_sliders) {
     int from = bitboard::pop_lsb(d_sliders);
     // if (pseudo_bishop_moves(from) & king_mask) {
-    attacks |= gen.attacks_from<Piece::bishop>(from);
+    attacks |= gen.template attacks_from<Piece::bishop>(from);
     //}
   }
 
@@ -95,7 +90,7 @@ uint64_t Board::get_attack_mask(uint64_t occupancy) const {
   while (h_sliders) {
     int from = bitboard::pop_lsb(h_sliders);
     // if (pseudo_rook_moves(from) & king_mask) {
-    attacks |= gen.attacks_from<Piece::rook>(from);
+    attacks |= gen.template attacks_from<Piece::rook>(from);
     //}
   }
 
@@ -117,6 +112,26 @@ Board::get_attack_mask<Player::white>(uint64_t occupancy) const;
 template uint64_t
 Board::get_attack_mask<Player::black>(uint64_t occupancy) const;
 
+// Pieces belonging to Stm that attack square, with sliders blocked by
+// occupancy.
+template <Player Stm>
+uint64_t Board::get_attackers(int square, uint64_t occupancy) const {
+  return (pseudo_pawn_attacks(!Stm, square) &
+          get_piece_mask<Stm, Piece::pawn>()) |
+         (attacks_from<Piece::knight>(square, occupancy) &
+          get_piece_mask<Stm, Piece::knight>()) |
+         (attacks_from<Piece::bishop>(square, occupancy) &
+          get_piece_mask<Stm, Piece::bishop, Piece::queen>()) |
+         (attacks_from<Piece::rook>(square, occupancy) &
+          get_piece_mask<Stm, Piece::rook, Piece::queen>()) |
+         (pseudo_king_moves(square) & get_piece_mask<Stm, Piece::king>());
+}
+
+template uint64_t Board::get_attackers<Player::white>(int square,
+                                                      uint64_t occupancy) const;
+template uint64_t Board::get_attackers<Player::black>(int square,
+                                                      uint64_t occupancy) const;
+
 template <Player Stm>
 bool Board::can_castle_kingside(uint64_t attack_mask) const {
   constexpr uint64_t kingside_castle_rights =
@@ -163,146 +178,271 @@ Board::can_castle_queenside<Player::white>(uint64_t attack_mask) const;
 template bool
 Board::can_castle_queenside<Player::black>(uint64_t attack_mask) const;
 
-template <Player Stm> void Board::make_move(Move move) {
-  ASSERT(is_valid(), this, "Board did not pass validation.");
-
-  const Piece moved = get_piece(move.from);
-  const Piece captured = get_piece(move.to);
-
-  unmake_stack.emplace_back(Unmake{captured, en_passant, castle_rights, key});
-
-  // Update piece location.
-  if (captured != Piece::none) {
-    remove_piece(!player, move.to);
+// True if move is legal for Stm. For moves that were not generated from this
+// position, such as a hash move or a killer, so they can be searched without
+// generating the move list.
+template <Player Stm> bool Board::is_legal(Move move) const {
+  const int from = move.from();
+  const int to = move.to();
+  const uint64_t from_mask = bitboard::to_bitboard(from);
+  const uint64_t to_mask = bitboard::to_bitboard(to);
+  if (!(get_occupied_mask<Stm>() & from_mask) ||
+      (get_occupied_mask<Stm>() & to_mask)) {
+    return false;
   }
-  remove_piece(player, move.from);
-  put_piece(player, moved, move.to);
 
-  if (en_passant) {
-    // Check if the move captures a pawn en passant.
-    if (move.to == en_passant && moved == Piece::pawn) {
-      int capture_square = en_passant + (move.from < move.to ? -8 : 8);
-      remove_piece(!player, capture_square);
-    }
-    // Clear en passant square.
-    set_key(key, en_passant);
-    en_passant = 0;
+  // The type has to be the one the generator gives the move.
+  const Piece moved = get_piece(from);
+  const bool promotes =
+      moved == Piece::pawn && (to_mask & PlayerTraits<Stm>::promotion_mask);
+  MoveType type = MoveType::normal;
+  if (moved == Piece::pawn && std::abs(from - to) == 16) {
+    type = MoveType::double_push;
+  } else if (moved == Piece::pawn && to == en_passant && en_passant != 0) {
+    type = MoveType::en_passant;
+  } else if (moved == Piece::king && std::abs(from - to) == 2) {
+    type = MoveType::castle;
   }
-
-  // Check for double push.
-  if (moved == Piece::pawn && abs(move.from - move.to) == 16) {
-    // Set new en passant square.
-    en_passant = (move.from + move.to) / 2;
-    set_key(key, en_passant);
+  if (promotes ? !move.is_promotion() : move.type() != type) {
+    return false;
   }
 
-  // Check for castling moves.
-  if (moved == Piece::king && abs(move.from - move.to) == 2) {
-    if (move.from > move.to) // Kingside castle
-    {
-      remove_piece(player, move.to - 1);
-      put_piece(player, Piece::rook, move.to + 1);
-    } else // Queenside castle
-    {
-      remove_piece(player, move.to + 2);
-      put_piece(player, Piece::rook, move.to - 1);
+  const uint64_t occupied = get_occupied_mask();
+  uint64_t captured = to_mask & get_occupied_mask<!Stm>();
+  uint64_t targets = 0u;
+  switch (moved) {
+  case Piece::pawn: {
+    MoveGen<Stm> gen(occupied);
+    const uint64_t en_passant_mask =
+        en_passant ? bitboard::to_bitboard(en_passant) : 0u;
+    targets = gen.pawn_push(from_mask) | gen.pawn_double_push(from_mask) |
+              (pawn_attacks(Stm, from_mask) &
+               (get_occupied_mask<!Stm>() | en_passant_mask));
+    if (type == MoveType::en_passant) {
+      captured = bitboard::to_bitboard(en_passant - PlayerTraits<Stm>::forward);
     }
+    break;
   }
-
-  // Check for promotion.
-  if (move.promotion != Piece::none) {
-    remove_piece(player, move.to);
-    put_piece(player, move.promotion, move.to);
+  case Piece::knight:
+    targets = attacks_from<Piece::knight>(from, occupied);
+    break;
+  case Piece::bishop:
+    targets = attacks_from<Piece::bishop>(from, occupied);
+    break;
+  case Piece::rook:
+    targets = attacks_from<Piece::rook>(from, occupied);
+    break;
+  case Piece::queen:
+    targets = attacks_from<Piece::queen>(from, occupied);
+    break;
+  case Piece::king:
+    if (type == MoveType::castle) {
+      // The king may not castle out of or through check.
+      const int step = to > from ? 1 : -1;
+      uint64_t attacks = 0u;
+      for (int square = from; square != to + step; square += step) {
+        if (get_attackers<!Stm>(square, occupied)) {
+          attacks |= bitboard::to_bitboard(square);
+        }
+      }
+      if (attacks & from_mask) {
+        return false;
+      }
+      return step < 0 ? can_castle_kingside<Stm>(attacks)
+                      : can_castle_queenside<Stm>(attacks);
+    }
+    if (pseudo_king_moves(from) & to_mask) {
+      // The king may not step along the ray of a slider it is moving away
+      // from, so look through its current square.
+      return get_attackers<!Stm>(to, occupied ^ from_mask) == 0u;
+    }
+    return false;
+  default:
+    return false;
   }
-
-  // Update castle rights.
-  if (castle_rights) {
-    set_key(key, castle_rights);
-    castle_rights &= castle_rights_mask[move.to];
-    castle_rights &= castle_rights_mask[move.from];
-    set_key(key, castle_rights);
+  if (!(targets & to_mask)) {
+    return false;
   }
 
-  // Update the side to move.
-  set_key(key, player);
-  player = !player;
-  set_key(key, player);
+  // The move is pseudo legal, so it only has to leave the king safe.
+  const uint64_t occupied_after = (occupied ^ from_mask ^ captured) | to_mask;
+  return (get_attackers<!Stm>(get_king_square<Stm>(), occupied_after) &
+          ~captured) == 0u;
+}
 
-  /*pinners = 0ull;
-  pinned = 0ull;
-  set_pins<!Stm>();*/
+template bool Board::is_legal<Player::white>(Move move) const;
+template bool Board::is_legal<Player::black>(Move move) const;
 
-  ASSERT(is_valid(), *this, "Board did not pass validation.");
+template <Player P> void Board::set_piece(Piece piece, int square) {
+  const uint64_t square_bit = bitboard::to_bitboard(square);
+  occupancy[static_cast<int>(P)] ^= square_bit;
+  pieces[piece] ^= square_bit;
+  board[square] = piece;
 }
 
-template void Board::make_move<Player::white>(Move move);
-template void Board::make_move<Player::black>(Move move);
-
-template <Player Stm> void Board::unmake_move(Move move) {
-  ASSERT(is_valid(), this, "Board did not pass validation.");
+template <Player P> void Board::clear_piece(Piece piece, int square) {
+  const uint64_t square_bit = bitboard::to_bitboard(square);
+  occupancy[static_cast<int>(P)] ^= square_bit;
+  pieces[piece] ^= square_bit;
+  board[square] = Piece::none;
+}
 
-  Unmake unmake = unmake_stack.back();
+template <Player P> void Board::move_piece(Piece piece, int from, int to) {
+  const uint64_t squares = bitboard::to_bitboard(from, to);
+  occupancy[static_cast<int>(P)] ^= squares;
+  pieces[piece] ^= squares;
+  board[from] = Piece::none;
+  board[to] = piece;
+}
 
-  const Piece moved = get_piece(move.to);
-  const Piece captured = unmake.captured;
+// Each kind of move has its own case, which changes only the pieces, en
+// passant square and castle rights that kind of move can change, and hashes
+// only those. The key is built in a local so it is not reloaded after every
+// bitboard store.
+template <Player Stm> void Board::make_move(Move move) {
+  ASSERT(is_valid(), this, "Board did not pass validation.");
 
-  // Update side to move.
-  set_key(key, player);
-  player = !player;
-  set_key(key, player);
+  constexpr Player enemy = !Stm;
+  const int from = move.from();
+  const int to = move.to();
+  const Piece captured = board[to];
 
-  // Update piece location.
-  remove_piece(player, move.to);
-  put_piece(player, moved, move.from);
-  if (captured != Piece::none) {
-    put_piece(!player, captured, move.to);
-  }
+  unmake_stack.emplace_back(Unmake{key, static_cast<uint8_t>(captured),
+                                   static_cast<uint8_t>(en_passant),
+                                   static_cast<uint8_t>(castle_rights)});
 
-  // Clear en passant.
+  // The side to move always changes and only black to move is hashed in.
+  uint64_t new_key = key ^ zobrist_keys.player_key;
   if (en_passant) {
-    set_key(key, en_passant);
+    set_key(new_key, en_passant);
+    en_passant = 0;
   }
 
-  en_passant = unmake.en_passant;
-  if (en_passant) {
-    // Check if the move captured a pawn en passant.
-    if (move.to == en_passant && moved == Piece::pawn) {
-      int captured_square = en_passant + (move.from < move.to ? -8 : 8);
-      put_piece(!player, Piece::pawn, captured_square);
+  // Only a move to or from a king or rook square can lose castle rights.
+  auto update_castle_rights = [&]() {
+    const unsigned rights =
+        castle_rights & castle_rights_mask[from] & castle_rights_mask[to];
+    if (rights != castle_rights) {
+      set_key(new_key, castle_rights);
+      set_key(new_key, rights);
+      castle_rights = rights;
     }
-    set_key(key, en_passant);
+  };
+
+  switch (move.type()) {
+  case MoveType::normal: {
+    const Piece moved = board[from];
+    if (captured != Piece::none) {
+      clear_piece<enemy>(captured, to);
+      new_key ^= piece_key(enemy, captured, to);
+    }
+    move_piece<Stm>(moved, from, to);
+    new_key ^= piece_key(Stm, moved, from) ^ piece_key(Stm, moved, to);
+    update_castle_rights();
+    break;
+  }
+  case MoveType::double_push:
+    move_piece<Stm>(Piece::pawn, from, to);
+    new_key ^= piece_key(Stm, Piece::pawn, from) ^
+               piece_key(Stm, Piece::pawn, to);
+    en_passant = (from + to) / 2;
+    set_key(new_key, en_passant);
+    break;
+  case MoveType::en_passant: {
+    const int capture_square = to - PlayerTraits<Stm>::forward;
+    clear_piece<enemy>(Piece::pawn, capture_square);
+    move_piece<Stm>(Piece::pawn, from, to);
+    new_key ^= piece_key(enemy, Piece::pawn, capture_square) ^
+               piece_key(Stm, Piece::pawn, from) ^
+               piece_key(Stm, Piece::pawn, to);
+    break;
+  }
+  case MoveType::castle: {
+    // The rook jumps from the corner to the square the king crossed.
+    const int rook_from = from > to ? to - 1 : to + 2;
+    const int rook_to = from > to ? to + 1 : to - 1;
+    move_piece<Stm>(Piece::king, from, to);
+    move_piece<Stm>(Piece::rook, rook_from, rook_to);
+    new_key ^= piece_key(Stm, Piece::king, from) ^
+               piece_key(Stm, Piece::king, to) ^
+               piece_key(Stm, Piece::rook, rook_from) ^
+               piece_key(Stm, Piece::rook, rook_to);
+    update_castle_rights();
+    break;
+  }
+  default: { // Promotions.
+    const Piece promotion = move.promotion();
+    if (captured != Piece::none) {
+      clear_piece<enemy>(captured, to);
+      new_key ^= piece_key(enemy, captured, to);
+    }
+    clear_piece<Stm>(Piece::pawn, from);
+    set_piece<Stm>(promotion, to);
+    new_key ^= piece_key(Stm, Piece::pawn, from) ^
+               piece_key(Stm, promotion, to);
+    update_castle_rights();
+    break;
+  }
   }
 
-  // Check for castling moves.
-  if (moved == Piece::king && abs(move.from - move.to) == 2) {
-    if (move.from > move.to) // Kingside castle
+  key = new_key;
+  player = enemy;
+
+  ASSERT(is_valid(), *this, "Board did not pass validation.");
+}
+
+template void Board::make_move<Player::white>(Move move);
+template void Board::make_move<Player::black>(Move move);
+
+// Stm is the side that made the move. The key, en passant square and castle
+// rights are restored from the unmake stack, so only the pieces are moved
+// back.
+template <Player Stm> void Board::unmake_move(Move move) {
+  ASSERT(is_valid(), this, "Board did not pass validation.");
+
+  constexpr Player enemy = !Stm;
+  const Unmake &unmake = unmake_stack.back();
+  const int from = move.from();
+  const int to = move.to();
+  const Piece captured = static_cast<Piece>(unmake.captured);
+
+  switch (move.type()) {
+  case MoveType::normal:
+    move_piece<Stm>(board[to], to, from);
+    if (captured != Piece::none) {
+      set_piece<enemy>(captured, to);
+    }
+    break;
+  case MoveType::double_push:
+    move_piece<Stm>(Piece::pawn, to, from);
+    break;
+  case MoveType::en_passant:
+    move_piece<Stm>(Piece::pawn, to, from);
+    set_piece<enemy>(Piece::pawn, to - PlayerTraits<Stm>::forward);
+    break;
+  case MoveType::castle:
+    move_piece<Stm>(Piece::king, to, from);
+    if (from > to) // Kingside castle
     {
-      remove_piece(player, move.to + 1);
-      put_piece(player, Piece::rook, move.to - 1);
+      move_piece<Stm>(Piece::rook, to + 1, to - 1);
     } else // Queenside castle
     {
-      remove_piece(player, move.to - 1);
-      put_piece(player, Piece::rook, move.to + 2);
+      move_piece<Stm>(Piece::rook, to - 1, to + 2);
     }
+    break;
+  default: // Promotions.
+    clear_piece<Stm>(move.promotion(), to);
+    set_piece<Stm>(Piece::pawn, from);
+    if (captured != Piece::none) {
+      set_piece<enemy>(captured, to);
+    }
+    break;
   }
 
-  // Check for promotion.
-  if (move.promotion != Piece::none) {
-    remove_piece(player, move.from);
-    put_piece(player, Piece::pawn, move.from);
-  }
-
-  // Update castle rights.
-  if (unmake.castle_rights) {
-    set_key(key, castle_rights);
-    castle_rights = unmake.castle_rights;
-    set_key(key, castle_rights);
-  }
-
-  /*pinners = unmake.pinners;
-  pinned = unmake.pinned;*/
-
-  ASSERT((key == unmake.key), key, "Key did not equal unmake.key");
+  key = unmake.key;
+  en_passant = unmake.en_passant;
+  castle_rights = unmake.castle_rights;
+  player = Stm;
 
   unmake_stack.pop_back();
   ASSERT(is_valid(), this, "Board did not pass validation.");
@@ -399,9 +539,9 @@ bool Board::is_valid() const {
 }
 
 std::ostream &operator<<(std::ostream &o, Board board) {
-  std::cout << "  ABCDEFGH\n";
+  o << "  ABCDEFGH\n";
   for (int rank = 7; rank >= 0; --rank) {
-    std::cout << rank + 1 << '|';
+    o << rank + 1 << '|';
     for (int file = 7; file >= 0; --file) {
       int square = rank * 8 + file;
       Player p = (board.get_occupied_mask<Player::white>() &
@@ -411,61 +551,62 @@ std::ostream &operator<<(std::ostream &o, Board board) {
       Piece piece = board.get_piece(square);
       switch (board.get_piece(square)) {
       case Piece::pawn:
-        std::cout << (p == Player::white ? 'P' : 'p');
+        o << (p == Player::white ? 'P' : 'p');
         break;
       case Piece::knight:
-        std::cout << (p == Player::white ? 'N' : 'n');
+        o << (p == Player::white ? 'N' : 'n');
         break;
       case Piece::bishop:
-        std::cout << (p == Player::white ? 'B' : 'b');
+        o << (p == Player::white ? 'B' : 'b');
         break;
       case Piece::rook:
-        std::cout << (p == Player::white ? 'R' : 'r');
+        o << (p == Player::white ? 'R' : 'r');
         break;
       case Piece::queen:
-        std::cout << (p == Player::white ? 'Q' : 'q');
+        o << (p == Player::white ? 'Q' : 'q');
         break;
       case Piece::king:
-        std::cout << (p == Player::white ? 'K' : 'k');
+        o << (p == Player::white ? 'K' : 'k');
         break;
       default:
-        std::cout << '.';
+        o << '.';
         break;
       }
     }
-    std::cout << '|' << rank + 1;
+    o << '|' << rank + 1;
     switch (rank) {
     case 7:
-      std::cout << std::setw(18) << "side to move: " << board.player << '\n';
+      o << std::setw(18) << "side to move: " << board.player << '\n';
       break;
     case 6:
-      std::cout << std::setw(18) << "castle rights: ";
+      o << std::setw(18) << "castle rights: ";
       if (board.castle_rights & kingside_castle_white) {
-        std::cout << "K";
+        o << "K";
       }
       if (board.castle_rights & queenside_castle_white) {
-        std::cout << "Q";
+        o << "Q";
       }
       if (board.castle_rights & kingside_castle_black) {
-        std::cout << "k";
+        o << "k";
       }
       if (board.castle_rights & queenside_castle_black) {
-        std::cout << "q";
+        o << "q";
       }
-      std::cout << '\n';
+      o << '\n';
       break;
     case 5:
-      std::cout << std::setw(18) << "en-passant: ";
+      o << std::setw(18) << "en-passant: ";
       if (board.en_passant == 0) {
-        std::cout << "-\n";
+        o << "-\n";
       } else {
-        std::cout << board.en_passant << '\n';
+        o << board.en_passant << '\n';
       }
       break;
     default:
-      std::cout << '\n';
+      o << '\n';
       break;
     }
   }
-  std::cout << "  ABCDEFGH";
+  o << "  ABCDEFGH";
+  return o;
 }
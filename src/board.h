@@ -17,6 +17,11 @@
 #include "move.h"
 #include "magic_moves.h"
 
+constexpr unsigned kingside_castle_white = 1;
+constexpr unsigned queenside_castle_white = 2;
+constexpr unsigned kingside_castle_black = 4;
+constexpr unsigned queenside_castle_black = 8;
+
 static const std::array<unsigned, 64> castle_rights_mask =
 {
     14, 15, 15, 12, 15, 15, 15, 13,
@@ -29,12 +34,13 @@ static const std::array<unsigned, 64> castle_rights_mask =
     11, 15, 15, 3,  15, 15, 15, 7
 };
 
+// The state make_move cannot recover from the move, in 16 bytes.
 struct Unmake
 {
-    Piece captured;
-    int en_passant;
-    unsigned castle_rights;
     uint64_t key;
+    uint8_t captured;
+    uint8_t en_passant;
+    uint8_t castle_rights;
    /* uint64_t pinned;
     uint64_t pinners;*/
 };
@@ -86,6 +92,14 @@ struct Board
     bool is_player(int square) const noexcept;
     void put_piece(Player player, Piece piece, int square);
     void remove_piece(Player player, int square);
+    // Bitboard and mailbox updates for make_move and unmake_move, which keep
+    // the key themselves.
+    template<Player P>
+    void set_piece(Piece piece, int square);
+    template<Player P>
+    void clear_piece(Piece piece, int square);
+    template<Player P>
+    void move_piece(Piece piece, int from, int to);
     template<Player Stm>
     uint64_t get_occupied_mask() const noexcept;
     uint64_t get_occupied_mask(Player player) const;
@@ -94,9 +108,13 @@ struct Board
     template<Player Stm>
     uint64_t get_attack_mask(uint64_t occupancy) const;
     template<Player Stm>
+    uint64_t get_attackers(int square, uint64_t occupancy) const;
+    template<Player Stm>
     bool can_castle_kingside(uint64_t attack_mask) const;
     template<Player Stm>
     bool can_castle_queenside(uint64_t attack_mask) const;
+    template<Player Stm>
+    bool is_legal(Move move) const;
     bool is_valid() const;
     template<Player Stm>
     void make_move(Move move);
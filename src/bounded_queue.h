@@ -0,0 +1,57 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Fixed capacity multi-producer, multi-consumer queue. push blocks while the
+// queue is full and pop blocks while it is empty, until close is called.
+template <class T> class BoundedQueue {
+private:
+  std::deque<T> _items;
+  size_t _capacity;
+  bool _closed;
+  std::mutex _mutex;
+  std::condition_variable _not_full;
+  std::condition_variable _not_empty;
+
+public:
+  explicit BoundedQueue(size_t capacity)
+      : _capacity(capacity > 0 ? capacity : 1), _closed(false) {}
+
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _not_full.wait(lock,
+                   [this] { return _closed || _items.size() < _capacity; });
+    if (_closed) {
+      return false;
+    }
+    _items.push_back(std::move(item));
+    _not_empty.notify_one();
+    return true;
+  }
+
+  // Returns false once the queue is closed and drained.
+  bool pop(T &item) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _not_empty.wait(lock, [this] { return _closed || !_items.empty(); });
+    if (_items.empty()) {
+      return false;
+    }
+    item = std::move(_items.front());
+    _items.pop_front();
+    _not_full.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _closed = true;
+    _not_full.notify_all();
+    _not_empty.notify_all();
+  }
+};
+
+#endif
@@ -0,0 +1,99 @@
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include "cpu_features.h"
+
+static void cpuid(unsigned leaf, unsigned subleaf, unsigned registers[4]) {
+  registers[0] = registers[1] = registers[2] = registers[3] = 0;
+#if defined(_MSC_VER) && CPU_FEATURES_X86
+  int values[4];
+  __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; ++i) {
+    registers[i] = static_cast<unsigned>(values[i]);
+  }
+#elif defined(__x86_64__)
+  __get_cpuid_count(leaf, subleaf, &registers[0], &registers[1],
+                    &registers[2], &registers[3]);
+#endif
+}
+
+bool cpu_supports_popcnt() {
+  unsigned registers[4];
+  cpuid(0, 0, registers);
+  if (registers[0] < 1) {
+    return false;
+  }
+  cpuid(1, 0, registers);
+  return (registers[2] & (1u << 23)) != 0;
+}
+
+bool cpu_supports_bmi2() {
+  unsigned registers[4];
+  cpuid(0, 0, registers);
+  if (registers[0] < 7) {
+    return false;
+  }
+  cpuid(7, 0, registers);
+  return (registers[1] & (1u << 3)) != 0 && (registers[1] & (1u << 8)) != 0;
+}
+
+bool cpu_supports_pext(bool fast_pext) {
+#if CPU_FEATURES_X86
+  unsigned registers[4];
+  cpuid(0, 0, registers);
+  if (registers[0] < 7) {
+    return false;
+  }
+  const bool amd = registers[1] == 0x68747541; // "Auth"enticAMD
+
+  cpuid(7, 0, registers);
+  if ((registers[1] & (1u << 8)) == 0) {
+    return false;
+  }
+  if (fast_pext && amd) {
+    cpuid(1, 0, registers);
+    unsigned family = (registers[0] >> 8) & 0xf;
+    if (family == 0xf) {
+      family += (registers[0] >> 20) & 0xff;
+    }
+    return family >= 0x19;
+  }
+  return true;
+#else
+  (void)fast_pext;
+  return false;
+#endif
+}
+
+bool cpu_supports_avx2() {
+#if CPU_FEATURES_X86
+  unsigned registers[4];
+  cpuid(0, 0, registers);
+  if (registers[0] < 7) {
+    return false;
+  }
+  // OSXSAVE, then XCR0 must have the SSE and AVX state enabled.
+  cpuid(1, 0, registers);
+  if ((registers[2] & (1u << 27)) == 0) {
+    return false;
+  }
+#if defined(_MSC_VER)
+  const unsigned long long xcr0 = _xgetbv(0);
+#else
+  unsigned eax = 0;
+  unsigned edx = 0;
+  __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  const unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+  if ((xcr0 & 0x6) != 0x6) {
+    return false;
+  }
+  cpuid(7, 0, registers);
+  return (registers[1] & (1u << 5)) != 0;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,24 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// Instruction set extensions of the host, read with CPUID. All of them are
+// false on other architectures.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPU_FEATURES_X86 1
+#else
+#define CPU_FEATURES_X86 0
+#endif
+
+bool cpu_supports_popcnt();
+
+// True when the CPU has BMI1 and BMI2: tzcnt, blsr and pext.
+bool cpu_supports_bmi2();
+
+// True when the CPU has BMI2. fast_pext additionally excludes the AMD cores
+// before Zen 3, which implement PEXT in microcode.
+bool cpu_supports_pext(bool fast_pext = false);
+
+// True when the CPU has AVX2 and the OS saves the YMM registers.
+bool cpu_supports_avx2();
+
+#endif
@@ -0,0 +1,227 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+
+#include "epd.h"
+
+namespace epd
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path)
+    {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+        _file = file;
+        _opened = true;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            _opened = false;
+            return;
+        }
+        _mapping = mapping;
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            _opened = false;
+            return;
+        }
+        _data = static_cast<const char*>(data);
+        _size = static_cast<size_t>(size.QuadPart);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (_data != nullptr)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping != nullptr)
+        {
+            CloseHandle(_mapping);
+        }
+        if (_file != nullptr)
+        {
+            CloseHandle(_file);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) == 0)
+        {
+            _opened = true;
+            if (info.st_size > 0)
+            {
+                void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED)
+                {
+                    _opened = false;
+                }
+                else
+                {
+                    madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                    _data = static_cast<const char*>(data);
+                    _size = static_cast<size_t>(info.st_size);
+                }
+            }
+        }
+        // The mapping stays valid after the descriptor is closed.
+        close(fd);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (_data != nullptr)
+        {
+            munmap(const_cast<char*>(_data), _size);
+        }
+    }
+#endif
+
+    namespace
+    {
+        const char* skip_spaces(const char* cursor, const char* end)
+        {
+            while (cursor < end && isspace(static_cast<unsigned char>(*cursor)))
+            {
+                ++cursor;
+            }
+            return cursor;
+        }
+
+        // Parse an unsigned integer without running past the end of the
+        // mapping, which is not null terminated.
+        const char* parse_number(const char* cursor, const char* end, uint64_t& value, bool& valid)
+        {
+            value = 0;
+            valid = cursor < end && isdigit(static_cast<unsigned char>(*cursor));
+            while (cursor < end && isdigit(static_cast<unsigned char>(*cursor)))
+            {
+                value = value * 10 + (*cursor - '0');
+                ++cursor;
+            }
+            return cursor;
+        }
+    }
+
+    Reader::Reader(const std::string& path, int max_depth)
+        : _file(path), _cursor(_file.begin()), _line_end(_file.begin()), _entry(_file.begin()),
+          _max_depth(max_depth), _line_number(0)
+    {}
+
+    // Move to the next line holding a position, leaving _entry at its first
+    // ';' separated field.
+    bool Reader::next_line()
+    {
+        while (_cursor < _file.end())
+        {
+            const char* line = _cursor;
+            _line_end = line;
+            while (_line_end < _file.end() && *_line_end != '\n')
+            {
+                ++_line_end;
+            }
+            _cursor = _line_end < _file.end() ? _line_end + 1 : _line_end;
+            ++_line_number;
+
+            line = skip_spaces(line, _line_end);
+            if (line == _line_end || *line == '#')
+            {
+                continue;
+            }
+
+            const char* fen_end = line;
+            while (fen_end < _line_end && *fen_end != ';')
+            {
+                ++fen_end;
+            }
+            const char* trimmed = fen_end;
+            while (trimmed > line && isspace(static_cast<unsigned char>(trimmed[-1])))
+            {
+                --trimmed;
+            }
+            _fen.assign(line, trimmed);
+            _entry = fen_end;
+            return true;
+        }
+        return false;
+    }
+
+    bool Reader::next(PerftTest& test)
+    {
+        while (true)
+        {
+            // Walk the remaining ";Dn count" fields of the current line.
+            while (_entry < _line_end)
+            {
+                const char* field = skip_spaces(_entry + 1, _line_end);
+                _entry = field;
+                while (_entry < _line_end && *_entry != ';')
+                {
+                    ++_entry;
+                }
+
+                if (field == _entry || (*field != 'D' && *field != 'd'))
+                {
+                    continue;
+                }
+
+                uint64_t depth;
+                uint64_t nodes;
+                bool depth_valid;
+                bool nodes_valid;
+                const char* cursor = parse_number(field + 1, _entry, depth, depth_valid);
+                cursor = skip_spaces(cursor, _entry);
+                parse_number(cursor, _entry, nodes, nodes_valid);
+                if (!depth_valid || !nodes_valid)
+                {
+                    std::cout << "Perft file line " << _line_number << " has an invalid depth entry." << std::endl;
+                    continue;
+                }
+                if (_max_depth > 0 && static_cast<int>(depth) > _max_depth)
+                {
+                    continue;
+                }
+
+                test = PerftTest(_fen, static_cast<int>(depth), nodes);
+                return true;
+            }
+
+            if (!next_line())
+            {
+                return false;
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef EPD_H
+#define EPD_H
+
+#include <cstddef>
+#include <string>
+
+#include "perft_test.h"
+
+namespace epd
+{
+    // Read only view of a whole file mapped into memory.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string& path);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        bool is_open() const { return _opened; }
+        const char* begin() const { return _data; }
+        const char* end() const { return _data + _size; }
+
+    private:
+        const char* _data = nullptr;
+        size_t _size = 0;
+        bool _opened = false;
+#ifdef _WIN32
+        void* _file = nullptr;
+        void* _mapping = nullptr;
+#endif
+    };
+
+    // Lazily parses perft suites in the EPD style
+    //     <fen> ;D1 20 ;D2 400 ;D3 8902
+    // one line at a time, producing a PerftTest for each depth entry. Blank
+    // lines and lines starting with '#' are skipped. A max_depth of zero
+    // reads every depth.
+    class Reader
+    {
+    public:
+        explicit Reader(const std::string& path, int max_depth = 0);
+
+        bool is_open() const { return _file.is_open(); }
+        bool next(PerftTest& test);
+        int get_line_number() const { return _line_number; }
+
+    private:
+        bool next_line();
+
+        MappedFile _file;
+        const char* _cursor;
+        const char* _line_end;
+        const char* _entry;
+        std::string _fen;
+        int _max_depth;
+        int _line_number;
+    };
+}
+
+#endif
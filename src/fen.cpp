@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 #include <vector>
 #include <unordered_map>
@@ -106,7 +108,9 @@ namespace fen
         std::vector<std::string> fen_vec(6);
         std::istringstream iss(fen_string);
         std::vector<std::string> fen_split{ std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>{} };
-        std::copy(fen_split.begin(), fen_split.end(), fen_vec.begin());
+        // EPD positions only have the first four fields, anything past the
+        // sixth is not part of the fen.
+        std::copy_n(fen_split.begin(), std::min(fen_split.size(), fen_vec.size()), fen_vec.begin());
         return fen_vec;
     }
 
@@ -123,4 +127,65 @@ namespace fen
         board.init();
         return board;
     }
+
+    std::string to_fen(const Board& board)
+    {
+        const std::string piece_to_char = " pnbrqk";
+        std::string fen_string;
+        for (int rank = 7; rank >= 0; --rank)
+        {
+            int empty_squares = 0;
+            for (int square = rank * 8 + 7; square >= rank * 8; --square)
+            {
+                Piece piece = board.board[square];
+                if (piece == Piece::none)
+                {
+                    empty_squares += 1;
+                    continue;
+                }
+                if (empty_squares > 0)
+                {
+                    fen_string += static_cast<char>('0' + empty_squares);
+                    empty_squares = 0;
+                }
+                char c = piece_to_char[piece];
+                fen_string += board.occupancy[static_cast<int>(Player::white)] & (1ull << square) ? static_cast<char>(toupper(c)) : c;
+            }
+            if (empty_squares > 0)
+            {
+                fen_string += static_cast<char>('0' + empty_squares);
+            }
+            if (rank > 0)
+            {
+                fen_string += '/';
+            }
+        }
+
+        fen_string += board.player == Player::white ? " w " : " b ";
+
+        std::string castling_availability;
+        const std::string castle_chars = "KQkq";
+        for (int i = 0; i < 4; ++i)
+        {
+            if (board.castle_rights & (1u << i))
+            {
+                castling_availability += castle_chars[i];
+            }
+        }
+        fen_string += castling_availability.empty() ? "-" : castling_availability;
+
+        fen_string += ' ';
+        if (board.en_passant)
+        {
+            fen_string += static_cast<char>('h' - board.en_passant % 8);
+            fen_string += static_cast<char>('1' + board.en_passant / 8);
+        }
+        else
+        {
+            fen_string += '-';
+        }
+
+        fen_string += ' ' + std::to_string(board.halfmove_clock) + ' ' + std::to_string(board.fullmove_number);
+        return fen_string;
+    }
 }
\ No newline at end of file
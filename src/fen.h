@@ -8,6 +8,7 @@
 namespace fen
 {
     Board create_board(const std::string& fen_string);
+    std::string to_fen(const Board& board);
 }
 
 #endif
\ No newline at end of file
@@ -1,75 +1,40 @@
-#include <random>
 #include <array>
-#include <vector>
+#include <cstdint>
 
-#include "player.h"
-#include "piece.h"
+#include "hash.h"
 
-struct ZobristKeys
+// splitmix64 maps each state of its counter to a different output, so the 921
+// keys are distinct without having to check them.
+constexpr uint64_t splitmix64(uint64_t& state)
 {
-    uint64_t player_key;
-    std::array<uint64_t, 16> castle_keys;
-    std::array<uint64_t, 8> en_passant_keys;
-    std::array<uint64_t, 896> piece_keys;
-} zobrist_keys;
-
-uint64_t& set_key(uint64_t& key, Player player)
-{
-    key ^= zobrist_keys.player_key;
-    return key;
-}
-
-uint64_t& set_key(uint64_t& key, unsigned castle_rights)
-{
-    key ^= zobrist_keys.castle_keys[castle_rights];
-    return key;
-}
-
-uint64_t& set_key(uint64_t& key, int en_passant_square)
-{
-    key ^= zobrist_keys.en_passant_keys[en_passant_square % 8];
-    return key;
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
 }
 
-uint64_t& set_key(uint64_t& key, Player player, Piece piece, int square)
+constexpr ZobristKeys create_zobrist_keys()
 {
-    key ^= zobrist_keys.piece_keys[static_cast<int>(player) + 2 * (piece + 7 * square)];
-    return key;
-}
-
-// Initialize zobrist struct with distinct random keys.
-void hash_init()
-{
-    std::random_device rd;
-    std::mt19937 mt(rd());
-    std::uniform_int_distribution<uint64_t> d;
+    uint64_t state = 0x2545f4914f6cdd1dull;
+    ZobristKeys keys{};
+    keys.player_key = splitmix64(state);
 
-    std::vector<uint64_t> distinct_keys;
-    while (distinct_keys.size() < 921)
+    for (uint64_t& key : keys.castle_keys)
     {
-        uint64_t rand_key = d(mt);
-        if (std::find(distinct_keys.begin(), distinct_keys.end(), rand_key) == distinct_keys.end())
-        {
-            distinct_keys.emplace_back(rand_key);
-        }
+        key = splitmix64(state);
     }
 
-
-    int copy_idx = 0;
-    zobrist_keys.player_key = distinct_keys[copy_idx++];
-
-    for (uint64_t& key : zobrist_keys.castle_keys)
+    for (uint64_t& key : keys.en_passant_keys)
     {
-        key = distinct_keys[copy_idx++];
+        key = splitmix64(state);
     }
 
-    for (uint64_t& key : zobrist_keys.en_passant_keys)
+    for (uint64_t& key : keys.piece_keys)
     {
-        key = distinct_keys[copy_idx++];
+        key = splitmix64(state);
     }
+    return keys;
+}
 
-    for (uint64_t& key : zobrist_keys.piece_keys)
-    {
-        key = distinct_keys[copy_idx++];
-    }
-}
\ No newline at end of file
+// Generated at compile time, the same in every process.
+extern constexpr ZobristKeys zobrist_keys = create_zobrist_keys();
@@ -3,14 +3,55 @@
 
 #include <iostream>
 #include <array>
+#include <cstdint>
 
 #include "player.h"
 #include "piece.h"
 
-void hash_init();
-uint64_t& set_key(uint64_t& key, Player player);
-uint64_t& set_key(uint64_t& key, unsigned castle_rights);
-uint64_t& set_key(uint64_t& key, int en_passant_square);
-uint64_t& set_key(uint64_t& key, Player player, Piece piece, int square);
+struct ZobristKeys
+{
+    uint64_t player_key;
+    std::array<uint64_t, 16> castle_keys;
+    std::array<uint64_t, 8> en_passant_keys;
+    std::array<uint64_t, 896> piece_keys;
+};
+
+// Defined in hash.cpp. The keys are declared here so set_key inlines into
+// make_move rather than being a call per update.
+extern const ZobristKeys zobrist_keys;
+
+inline uint64_t piece_key(Player player, Piece piece, int square)
+{
+    return zobrist_keys.piece_keys[static_cast<int>(player) + 2 * (piece + 7 * square)];
+}
+
+// Only black to move is hashed in, so the key toggles once when the side to
+// move is cleared and set again in make_move.
+inline uint64_t& set_key(uint64_t& key, Player player)
+{
+    if (player == Player::black)
+    {
+        key ^= zobrist_keys.player_key;
+    }
+    return key;
+}
+
+inline uint64_t& set_key(uint64_t& key, unsigned castle_rights)
+{
+    key ^= zobrist_keys.castle_keys[castle_rights];
+    return key;
+}
+
+inline uint64_t& set_key(uint64_t& key, int en_passant_square)
+{
+    key ^= zobrist_keys.en_passant_keys[en_passant_square % 8];
+    return key;
+}
+
+inline uint64_t& set_key(uint64_t& key, Player player, Piece piece, int square)
+{
+    key ^= piece_key(player, piece, square);
+    return key;
+}
 
 #endif
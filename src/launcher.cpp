@@ -0,0 +1,86 @@
+// Runs the fastest build of CleverGirl2 the host supports. The CMake build
+// produces one binary per instruction set next to this one, named
+// clevergirl2-<variant>, and the launcher replaces itself with the best of
+// them that is installed. Set CLEVERGIRL2_VARIANT to force one.
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include "cpu_features.h"
+
+namespace
+{
+    struct Variant
+    {
+        const char* name;
+        bool (*supported)();
+    };
+
+    bool always()
+    {
+        return true;
+    }
+
+    bool popcnt()
+    {
+        return cpu_supports_popcnt();
+    }
+
+    bool bmi2()
+    {
+        return cpu_supports_popcnt() && cpu_supports_bmi2();
+    }
+
+    bool avx2()
+    {
+        return bmi2() && cpu_supports_avx2();
+    }
+
+    // Best first.
+    const Variant variants[] = {
+        { "avx2", avx2 },
+        { "bmi2", bmi2 },
+        { "popcnt", popcnt },
+        { "generic", always },
+    };
+
+    std::string executable_directory()
+    {
+        std::string path(4096, '\0');
+        ssize_t size = readlink("/proc/self/exe", &path[0], path.size());
+        if (size <= 0)
+        {
+            return ".";
+        }
+        path.resize(static_cast<size_t>(size));
+        return path.substr(0, path.find_last_of('/'));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    const std::string directory = executable_directory();
+    const char* forced = std::getenv("CLEVERGIRL2_VARIANT");
+
+    for (const auto& variant : variants)
+    {
+        if (forced ? std::string(forced) != variant.name : !variant.supported())
+        {
+            continue;
+        }
+        const std::string path = directory + "/clevergirl2-" + variant.name;
+        if (access(path.c_str(), X_OK) != 0)
+        {
+            continue;
+        }
+        argv[0] = const_cast<char*>(path.c_str());
+        execv(path.c_str(), argv);
+        std::cerr << "Could not run " << path << '\n';
+        return 1;
+    }
+
+    std::cerr << "No clevergirl2 build for this CPU in " << directory << '\n';
+    return 1;
+}
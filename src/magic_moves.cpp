@@ -8,6 +8,9 @@
  *The magic keys are not optimal for all squares but they are very close
  *to optimal.
  *
+ *Altered for CleverGirl2: with MINIMIZE_MAGIC the databases are generated
+ *at compile time instead of by initmagicmoves().
+ *
  *Copyright (C) 2007 Pradyumna Kannan.
  *
  *This code is provided 'as-is', without any express or implied warranty.
@@ -27,6 +30,8 @@
  *3. This notice may not be removed or altered from any source distribution.
  */
 
+#include <utility>
+
 #include "magic_moves.h"
 
 #ifdef _MSC_VER
@@ -49,7 +54,7 @@
  //C64(0x007FFCDDFCED714A) - B8 10 bit
  //C64(0x003FFFCDFFD88096) - C8 10 bit
 
-const unsigned int magicmoves_r_shift[64] =
+constexpr unsigned int magicmoves_r_shift[64] =
 {
     52, 53, 53, 53, 53, 53, 53, 52,
     53, 54, 54, 54, 54, 54, 54, 53,
@@ -61,7 +66,7 @@ const unsigned int magicmoves_r_shift[64] =
     53, 54, 54, 53, 53, 53, 53, 53
 };
 
-const U64 magicmoves_r_magics[64] =
+constexpr U64 magicmoves_r_magics[64] =
 {
     C64(0x0080001020400080), C64(0x0040001000200040), C64(0x0080081000200080), C64(0x0080040800100080),
     C64(0x0080020400080080), C64(0x0080010200040080), C64(0x0080008001000200), C64(0x0080002040800100),
@@ -80,7 +85,7 @@ const U64 magicmoves_r_magics[64] =
     C64(0x00FFFCDDFCED714A), C64(0x007FFCDDFCED714A), C64(0x003FFFCDFFD88096), C64(0x0000040810002101),
     C64(0x0001000204080011), C64(0x0001000204000801), C64(0x0001000082000401), C64(0x0001FFFAABFAD1A2)
 };
-const U64 magicmoves_r_mask[64] =
+constexpr U64 magicmoves_r_mask[64] =
 {
     C64(0x000101010101017E), C64(0x000202020202027C), C64(0x000404040404047A), C64(0x0008080808080876),
     C64(0x001010101010106E), C64(0x002020202020205E), C64(0x004040404040403E), C64(0x008080808080807E),
@@ -101,7 +106,7 @@ const U64 magicmoves_r_mask[64] =
 };
 
 //my original tables for bishops
-const unsigned int magicmoves_b_shift[64] =
+constexpr unsigned int magicmoves_b_shift[64] =
 {
     58, 59, 59, 59, 59, 59, 59, 58,
     59, 59, 59, 59, 59, 59, 59, 59,
@@ -113,7 +118,7 @@ const unsigned int magicmoves_b_shift[64] =
     58, 59, 59, 59, 59, 59, 59, 58
 };
 
-const U64 magicmoves_b_magics[64] =
+constexpr U64 magicmoves_b_magics[64] =
 {
     C64(0x0002020202020200), C64(0x0002020202020000), C64(0x0004010202000000), C64(0x0004040080000000),
     C64(0x0001104000000000), C64(0x0000821040000000), C64(0x0000410410400000), C64(0x0000104104104000),
@@ -134,7 +139,7 @@ const U64 magicmoves_b_magics[64] =
 };
 
 
-const U64 magicmoves_b_mask[64] =
+constexpr U64 magicmoves_b_mask[64] =
 {
     C64(0x0040201008040200), C64(0x0000402010080400), C64(0x0000004020100A00), C64(0x0000000040221400),
     C64(0x0000000002442800), C64(0x0000000204085000), C64(0x0000020408102000), C64(0x0002040810204000),
@@ -154,28 +159,7 @@ const U64 magicmoves_b_mask[64] =
     C64(0x0028440200000000), C64(0x0050080402000000), C64(0x0020100804020000), C64(0x0040201008040200)
 };
 
-#ifdef MINIMIZE_MAGIC
-U64 magicmovesbdb[5248];
-const U64* magicmoves_b_indices[64] =
-{
-    magicmovesbdb + 4992, magicmovesbdb + 2624,  magicmovesbdb + 256,  magicmovesbdb + 896,
-    magicmovesbdb + 1280, magicmovesbdb + 1664, magicmovesbdb + 4800, magicmovesbdb + 5120,
-    magicmovesbdb + 2560, magicmovesbdb + 2656,  magicmovesbdb + 288,  magicmovesbdb + 928,
-    magicmovesbdb + 1312, magicmovesbdb + 1696, magicmovesbdb + 4832, magicmovesbdb + 4928,
-    magicmovesbdb + 0,     magicmovesbdb + 128,  magicmovesbdb + 320,  magicmovesbdb + 960,
-    magicmovesbdb + 1344, magicmovesbdb + 1728, magicmovesbdb + 2304, magicmovesbdb + 2432,
-    magicmovesbdb + 32,    magicmovesbdb + 160,  magicmovesbdb + 448, magicmovesbdb + 2752,
-    magicmovesbdb + 3776, magicmovesbdb + 1856, magicmovesbdb + 2336, magicmovesbdb + 2464,
-    magicmovesbdb + 64,    magicmovesbdb + 192,  magicmovesbdb + 576, magicmovesbdb + 3264,
-    magicmovesbdb + 4288, magicmovesbdb + 1984, magicmovesbdb + 2368, magicmovesbdb + 2496,
-    magicmovesbdb + 96,    magicmovesbdb + 224,  magicmovesbdb + 704, magicmovesbdb + 1088,
-    magicmovesbdb + 1472, magicmovesbdb + 2112, magicmovesbdb + 2400, magicmovesbdb + 2528,
-    magicmovesbdb + 2592, magicmovesbdb + 2688,  magicmovesbdb + 832, magicmovesbdb + 1216,
-    magicmovesbdb + 1600, magicmovesbdb + 2240, magicmovesbdb + 4864, magicmovesbdb + 4960,
-    magicmovesbdb + 5056, magicmovesbdb + 2720,  magicmovesbdb + 864, magicmovesbdb + 1248,
-    magicmovesbdb + 1632, magicmovesbdb + 2272, magicmovesbdb + 4896, magicmovesbdb + 5184
-};
-#else
+#ifndef MINIMIZE_MAGIC
 #ifndef PERFECT_MAGIC_HASH
 U64 magicmovesbdb[64][1 << 9];
 #else
@@ -184,28 +168,7 @@ PERFECT_MAGIC_HASH magicmoves_b_indices[64][1 << 9];
 #endif
 #endif
 
-#ifdef MINIMIZE_MAGIC
-U64 magicmovesrdb[102400];
-const U64* magicmoves_r_indices[64] =
-{
-    magicmovesrdb + 86016, magicmovesrdb + 73728, magicmovesrdb + 36864, magicmovesrdb + 43008,
-    magicmovesrdb + 47104, magicmovesrdb + 51200, magicmovesrdb + 77824, magicmovesrdb + 94208,
-    magicmovesrdb + 69632, magicmovesrdb + 32768, magicmovesrdb + 38912, magicmovesrdb + 10240,
-    magicmovesrdb + 14336, magicmovesrdb + 53248, magicmovesrdb + 57344, magicmovesrdb + 81920,
-    magicmovesrdb + 24576, magicmovesrdb + 33792,  magicmovesrdb + 6144, magicmovesrdb + 11264,
-    magicmovesrdb + 15360, magicmovesrdb + 18432, magicmovesrdb + 58368, magicmovesrdb + 61440,
-    magicmovesrdb + 26624,  magicmovesrdb + 4096,  magicmovesrdb + 7168,     magicmovesrdb + 0,
-     magicmovesrdb + 2048, magicmovesrdb + 19456, magicmovesrdb + 22528, magicmovesrdb + 63488,
-    magicmovesrdb + 28672,  magicmovesrdb + 5120,  magicmovesrdb + 8192,  magicmovesrdb + 1024,
-     magicmovesrdb + 3072, magicmovesrdb + 20480, magicmovesrdb + 23552, magicmovesrdb + 65536,
-    magicmovesrdb + 30720, magicmovesrdb + 34816,  magicmovesrdb + 9216, magicmovesrdb + 12288,
-    magicmovesrdb + 16384, magicmovesrdb + 21504, magicmovesrdb + 59392, magicmovesrdb + 67584,
-    magicmovesrdb + 71680, magicmovesrdb + 35840, magicmovesrdb + 39936, magicmovesrdb + 13312,
-    magicmovesrdb + 17408, magicmovesrdb + 54272, magicmovesrdb + 60416, magicmovesrdb + 83968,
-    magicmovesrdb + 90112, magicmovesrdb + 75776, magicmovesrdb + 40960, magicmovesrdb + 45056,
-    magicmovesrdb + 49152, magicmovesrdb + 55296, magicmovesrdb + 79872, magicmovesrdb + 98304
-};
-#else
+#ifndef MINIMIZE_MAGIC
 #ifndef PERFECT_MAGIC_HASH
 U64 magicmovesrdb[64][1 << 12];
 #else
@@ -214,19 +177,19 @@ PERFECT_MAGIC_HASH magicmoves_r_indices[64][1 << 12];
 #endif
 #endif
 
-U64 initmagicmoves_occ(const int* squares, const int numSquares, const U64 linocc)
+constexpr U64 initmagicmoves_occ(const int* squares, const int numSquares, const U64 linocc)
 {
-    int i;
+    int i = 0;
     U64 ret = 0;
     for (i = 0; i < numSquares; i++)
         if (linocc&(((U64)(1)) << i)) ret |= (((U64)(1)) << squares[i]);
     return ret;
 }
 
-U64 initmagicmoves_Rmoves(const int square, const U64 occ)
+constexpr U64 initmagicmoves_Rmoves(const int square, const U64 occ)
 {
     U64 ret = 0;
-    U64 bit;
+    U64 bit = 0;
     U64 rowbits = (((U64)0xFF) << (8 * (square / 8)));
 
     bit = (((U64)(1)) << square);
@@ -258,11 +221,11 @@ U64 initmagicmoves_Rmoves(const int square, const U64 occ)
     return ret;
 }
 
-U64 initmagicmoves_Bmoves(const int square, const U64 occ)
+constexpr U64 initmagicmoves_Bmoves(const int square, const U64 occ)
 {
     U64 ret = 0;
-    U64 bit;
-    U64 bit2;
+    U64 bit = 0;
+    U64 bit2 = 0;
     U64 rowbits = (((U64)0xFF) << (8 * (square / 8)));
 
     bit = (((U64)(1)) << square);
@@ -304,13 +267,143 @@ U64 initmagicmoves_Bmoves(const int square, const U64 occ)
     return ret;
 }
 
+#ifdef MINIMIZE_MAGIC
+//The minimized databases are generated at compile time, so they are read only
+//data shared by every process and initmagicmoves() has nothing left to do.
+//Offsets of each square in the databases, as used by magicmoves_x_indices.
+constexpr int magicmoves_b_offsets[64] =
+{
+    4992, 2624, 256, 896, 1280, 1664, 4800, 5120,
+    2560, 2656, 288, 928, 1312, 1696, 4832, 4928,
+    0, 128, 320, 960, 1344, 1728, 2304, 2432,
+    32, 160, 448, 2752, 3776, 1856, 2336, 2464,
+    64, 192, 576, 3264, 4288, 1984, 2368, 2496,
+    96, 224, 704, 1088, 1472, 2112, 2400, 2528,
+    2592, 2688, 832, 1216, 1600, 2240, 4864, 4960,
+    5056, 2720, 864, 1248, 1632, 2272, 4896, 5184
+};
+
+constexpr int magicmoves_r_offsets[64] =
+{
+    86016, 73728, 36864, 43008, 47104, 51200, 77824, 94208,
+    69632, 32768, 38912, 10240, 14336, 53248, 57344, 81920,
+    24576, 33792, 6144, 11264, 15360, 18432, 58368, 61440,
+    26624, 4096, 7168, 0, 2048, 19456, 22528, 63488,
+    28672, 5120, 8192, 1024, 3072, 20480, 23552, 65536,
+    30720, 34816, 9216, 12288, 16384, 21504, 59392, 67584,
+    71680, 35840, 39936, 13312, 17408, 54272, 60416, 83968,
+    90112, 75776, 40960, 45056, 49152, 55296, 79872, 98304
+};
+
+template <int Size>
+struct initmagicmoves_db
+{
+    U64 moves[Size];
+};
+
+//The moves of one square, walking the subsets of the mask with the
+//carry-rippler trick.  Every square is a constant expression of its own so
+//none of them runs into the compilers' constexpr step limits.
+template <int Size, class Moves>
+constexpr initmagicmoves_db<Size> initmagicmoves_square(const int square, const U64 mask, const U64 magic,
+    const unsigned int shift, Moves moves)
+{
+    initmagicmoves_db<Size> db{};
+    U64 occ = 0;
+    do
+    {
+        db.moves[(occ * magic) >> shift] = moves(square, occ);
+        occ = (occ - mask) & mask;
+    } while (occ);
+    return db;
+}
+
+template <int Square>
+constexpr initmagicmoves_db<1 << (64 - magicmoves_b_shift[Square])> magicmoves_b_square =
+    initmagicmoves_square<1 << (64 - magicmoves_b_shift[Square])>(Square, magicmoves_b_mask[Square],
+        magicmoves_b_magics[Square], magicmoves_b_shift[Square], initmagicmoves_Bmoves);
+
+template <int Square>
+constexpr initmagicmoves_db<1 << (64 - magicmoves_r_shift[Square])> magicmoves_r_square =
+    initmagicmoves_square<1 << (64 - magicmoves_r_shift[Square])>(Square, magicmoves_r_mask[Square],
+        magicmoves_r_magics[Square], magicmoves_r_shift[Square], initmagicmoves_Rmoves);
+
+template <int Size, int SquareSize>
+constexpr int initmagicmoves_copy(initmagicmoves_db<Size>& db, const int offset,
+    const initmagicmoves_db<SquareSize>& square)
+{
+    for (int i = 0; i < SquareSize; i++)
+        db.moves[offset + i] = square.moves[i];
+    return 0;
+}
+
+template <int... Squares>
+constexpr initmagicmoves_db<5248> initmagicmoves_bdb(std::integer_sequence<int, Squares...>)
+{
+    initmagicmoves_db<5248> db{};
+    int copied[] = { initmagicmoves_copy(db, magicmoves_b_offsets[Squares], magicmoves_b_square<Squares>)... };
+    (void)copied;
+    return db;
+}
+
+template <int... Squares>
+constexpr initmagicmoves_db<102400> initmagicmoves_rdb(std::integer_sequence<int, Squares...>)
+{
+    initmagicmoves_db<102400> db{};
+    int copied[] = { initmagicmoves_copy(db, magicmoves_r_offsets[Squares], magicmoves_r_square<Squares>)... };
+    (void)copied;
+    return db;
+}
+
+constexpr initmagicmoves_db<5248> magicmoves_b_db = initmagicmoves_bdb(std::make_integer_sequence<int, 64>{});
+constexpr const U64* magicmovesbdb = magicmoves_b_db.moves;
+const U64* magicmoves_b_indices[64] =
+{
+    magicmovesbdb + 4992, magicmovesbdb + 2624,  magicmovesbdb + 256,  magicmovesbdb + 896,
+    magicmovesbdb + 1280, magicmovesbdb + 1664, magicmovesbdb + 4800, magicmovesbdb + 5120,
+    magicmovesbdb + 2560, magicmovesbdb + 2656,  magicmovesbdb + 288,  magicmovesbdb + 928,
+    magicmovesbdb + 1312, magicmovesbdb + 1696, magicmovesbdb + 4832, magicmovesbdb + 4928,
+    magicmovesbdb + 0,     magicmovesbdb + 128,  magicmovesbdb + 320,  magicmovesbdb + 960,
+    magicmovesbdb + 1344, magicmovesbdb + 1728, magicmovesbdb + 2304, magicmovesbdb + 2432,
+    magicmovesbdb + 32,    magicmovesbdb + 160,  magicmovesbdb + 448, magicmovesbdb + 2752,
+    magicmovesbdb + 3776, magicmovesbdb + 1856, magicmovesbdb + 2336, magicmovesbdb + 2464,
+    magicmovesbdb + 64,    magicmovesbdb + 192,  magicmovesbdb + 576, magicmovesbdb + 3264,
+    magicmovesbdb + 4288, magicmovesbdb + 1984, magicmovesbdb + 2368, magicmovesbdb + 2496,
+    magicmovesbdb + 96,    magicmovesbdb + 224,  magicmovesbdb + 704, magicmovesbdb + 1088,
+    magicmovesbdb + 1472, magicmovesbdb + 2112, magicmovesbdb + 2400, magicmovesbdb + 2528,
+    magicmovesbdb + 2592, magicmovesbdb + 2688,  magicmovesbdb + 832, magicmovesbdb + 1216,
+    magicmovesbdb + 1600, magicmovesbdb + 2240, magicmovesbdb + 4864, magicmovesbdb + 4960,
+    magicmovesbdb + 5056, magicmovesbdb + 2720,  magicmovesbdb + 864, magicmovesbdb + 1248,
+    magicmovesbdb + 1632, magicmovesbdb + 2272, magicmovesbdb + 4896, magicmovesbdb + 5184
+};
+
+constexpr initmagicmoves_db<102400> magicmoves_r_db = initmagicmoves_rdb(std::make_integer_sequence<int, 64>{});
+constexpr const U64* magicmovesrdb = magicmoves_r_db.moves;
+const U64* magicmoves_r_indices[64] =
+{
+    magicmovesrdb + 86016, magicmovesrdb + 73728, magicmovesrdb + 36864, magicmovesrdb + 43008,
+    magicmovesrdb + 47104, magicmovesrdb + 51200, magicmovesrdb + 77824, magicmovesrdb + 94208,
+    magicmovesrdb + 69632, magicmovesrdb + 32768, magicmovesrdb + 38912, magicmovesrdb + 10240,
+    magicmovesrdb + 14336, magicmovesrdb + 53248, magicmovesrdb + 57344, magicmovesrdb + 81920,
+    magicmovesrdb + 24576, magicmovesrdb + 33792,  magicmovesrdb + 6144, magicmovesrdb + 11264,
+    magicmovesrdb + 15360, magicmovesrdb + 18432, magicmovesrdb + 58368, magicmovesrdb + 61440,
+    magicmovesrdb + 26624,  magicmovesrdb + 4096,  magicmovesrdb + 7168,     magicmovesrdb + 0,
+     magicmovesrdb + 2048, magicmovesrdb + 19456, magicmovesrdb + 22528, magicmovesrdb + 63488,
+    magicmovesrdb + 28672,  magicmovesrdb + 5120,  magicmovesrdb + 8192,  magicmovesrdb + 1024,
+     magicmovesrdb + 3072, magicmovesrdb + 20480, magicmovesrdb + 23552, magicmovesrdb + 65536,
+    magicmovesrdb + 30720, magicmovesrdb + 34816,  magicmovesrdb + 9216, magicmovesrdb + 12288,
+    magicmovesrdb + 16384, magicmovesrdb + 21504, magicmovesrdb + 59392, magicmovesrdb + 67584,
+    magicmovesrdb + 71680, magicmovesrdb + 35840, magicmovesrdb + 39936, magicmovesrdb + 13312,
+    magicmovesrdb + 17408, magicmovesrdb + 54272, magicmovesrdb + 60416, magicmovesrdb + 83968,
+    magicmovesrdb + 90112, magicmovesrdb + 75776, magicmovesrdb + 40960, magicmovesrdb + 45056,
+    magicmovesrdb + 49152, magicmovesrdb + 55296, magicmovesrdb + 79872, magicmovesrdb + 98304
+};
+#endif // MINIMIZE_MAGIC
+
 //used so that the original indices can be left as const so that the compiler can optimize better
 
 #ifndef PERFECT_MAGIC_HASH
-#ifdef MINIMIZE_MAGIC
-#define BmagicNOMASK2(square, occupancy) *(magicmoves_b_indices2[square]+(((occupancy)*magicmoves_b_magics[square])>>magicmoves_b_shift[square]))
-#define RmagicNOMASK2(square, occupancy) *(magicmoves_r_indices2[square]+(((occupancy)*magicmoves_r_magics[square])>>magicmoves_r_shift[square]))
-#else
+#ifndef MINIMIZE_MAGIC
 #define BmagicNOMASK2(square, occupancy) magicmovesbdb[square][((occupancy)*magicmoves_b_magics[square])>>MINIMAL_B_BITS_SHIFT(square)]
 #define RmagicNOMASK2(square, occupancy) magicmovesrdb[square][((occupancy)*magicmoves_r_magics[square])>>MINIMAL_R_BITS_SHIFT(square)]
 #endif
@@ -322,6 +415,7 @@ U64 initmagicmoves_Bmoves(const int square, const U64 occ)
 
 void initmagicmoves(void)
 {
+#ifndef MINIMIZE_MAGIC
     int i;
 
     //for bitscans :
@@ -336,49 +430,6 @@ void initmagicmoves(void)
     56, 45, 25, 31, 35, 16,  9, 12,
     44, 24, 15,  8, 23,  7,  6,  5 };
 
-#ifdef MINIMIZE_MAGIC
-    //identical to magicmove_x_indices except without the const modifer
-    U64* magicmoves_b_indices2[64] =
-    {
-        magicmovesbdb + 4992, magicmovesbdb + 2624,  magicmovesbdb + 256,  magicmovesbdb + 896,
-        magicmovesbdb + 1280, magicmovesbdb + 1664, magicmovesbdb + 4800, magicmovesbdb + 5120,
-        magicmovesbdb + 2560, magicmovesbdb + 2656,  magicmovesbdb + 288,  magicmovesbdb + 928,
-        magicmovesbdb + 1312, magicmovesbdb + 1696, magicmovesbdb + 4832, magicmovesbdb + 4928,
-        magicmovesbdb + 0,     magicmovesbdb + 128,  magicmovesbdb + 320,  magicmovesbdb + 960,
-        magicmovesbdb + 1344, magicmovesbdb + 1728, magicmovesbdb + 2304, magicmovesbdb + 2432,
-        magicmovesbdb + 32,    magicmovesbdb + 160,  magicmovesbdb + 448, magicmovesbdb + 2752,
-        magicmovesbdb + 3776, magicmovesbdb + 1856, magicmovesbdb + 2336, magicmovesbdb + 2464,
-        magicmovesbdb + 64,    magicmovesbdb + 192,  magicmovesbdb + 576, magicmovesbdb + 3264,
-        magicmovesbdb + 4288, magicmovesbdb + 1984, magicmovesbdb + 2368, magicmovesbdb + 2496,
-        magicmovesbdb + 96,    magicmovesbdb + 224,  magicmovesbdb + 704, magicmovesbdb + 1088,
-        magicmovesbdb + 1472, magicmovesbdb + 2112, magicmovesbdb + 2400, magicmovesbdb + 2528,
-        magicmovesbdb + 2592, magicmovesbdb + 2688,  magicmovesbdb + 832, magicmovesbdb + 1216,
-        magicmovesbdb + 1600, magicmovesbdb + 2240, magicmovesbdb + 4864, magicmovesbdb + 4960,
-        magicmovesbdb + 5056, magicmovesbdb + 2720,  magicmovesbdb + 864, magicmovesbdb + 1248,
-        magicmovesbdb + 1632, magicmovesbdb + 2272, magicmovesbdb + 4896, magicmovesbdb + 5184
-    };
-    U64* magicmoves_r_indices2[64] =
-    {
-        magicmovesrdb + 86016, magicmovesrdb + 73728, magicmovesrdb + 36864, magicmovesrdb + 43008,
-        magicmovesrdb + 47104, magicmovesrdb + 51200, magicmovesrdb + 77824, magicmovesrdb + 94208,
-        magicmovesrdb + 69632, magicmovesrdb + 32768, magicmovesrdb + 38912, magicmovesrdb + 10240,
-        magicmovesrdb + 14336, magicmovesrdb + 53248, magicmovesrdb + 57344, magicmovesrdb + 81920,
-        magicmovesrdb + 24576, magicmovesrdb + 33792,  magicmovesrdb + 6144, magicmovesrdb + 11264,
-        magicmovesrdb + 15360, magicmovesrdb + 18432, magicmovesrdb + 58368, magicmovesrdb + 61440,
-        magicmovesrdb + 26624,  magicmovesrdb + 4096,  magicmovesrdb + 7168,     magicmovesrdb + 0,
-        magicmovesrdb + 2048,  magicmovesrdb + 19456, magicmovesrdb + 22528, magicmovesrdb + 63488,
-        magicmovesrdb + 28672,  magicmovesrdb + 5120,  magicmovesrdb + 8192,  magicmovesrdb + 1024,
-        magicmovesrdb + 3072,  magicmovesrdb + 20480, magicmovesrdb + 23552, magicmovesrdb + 65536,
-        magicmovesrdb + 30720, magicmovesrdb + 34816,  magicmovesrdb + 9216, magicmovesrdb + 12288,
-        magicmovesrdb + 16384, magicmovesrdb + 21504, magicmovesrdb + 59392, magicmovesrdb + 67584,
-        magicmovesrdb + 71680, magicmovesrdb + 35840, magicmovesrdb + 39936, magicmovesrdb + 13312,
-        magicmovesrdb + 17408, magicmovesrdb + 54272, magicmovesrdb + 60416, magicmovesrdb + 83968,
-        magicmovesrdb + 90112, magicmovesrdb + 75776, magicmovesrdb + 40960, magicmovesrdb + 45056,
-        magicmovesrdb + 49152, magicmovesrdb + 55296, magicmovesrdb + 79872, magicmovesrdb + 98304
-    };
-#endif // MINIMIZE_MAGIC
-
-
 #ifdef PERFECT_MAGIC_HASH
     for (i = 0; i < 1428; i++)
         magicmovesbdb[i] = 0;
@@ -460,6 +511,7 @@ void initmagicmoves(void)
 #endif
         }
     }
+#endif // MINIMIZE_MAGIC
 }
 
 void initMagics()
@@ -1,9 +1,18 @@
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 #include "board.h"
 #include "fen.h"
 #include "move.h"
 #include "move_generator.h"
+#include "parallel_perft.h"
+#include "perft_checkpoint.h"
+#include "perft_batch.h"
+#include "perft_bench.h"
+#include "perft_divide.h"
+#include "perft_shard.h"
+#include "perft_stats.h"
 #include "perft.h"
 #include "hash.h"
 
@@ -11,8 +20,98 @@ int main(int argc, char* argv[])
 {
     std::cout << std::is_pod<Board>::value << '\n';
     move_generator_init();
-    bitboard::init();
-    hash_init();
+
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "parallel")
+    {
+        unsigned threads = argc > 2 ? std::atoi(argv[2]) : default_thread_count();
+        size_t hash_megabytes = argc > 3 ? std::atoi(argv[3]) : 0;
+        parallel_speed(threads, hash_megabytes);
+        return 0;
+    }
+    if (command == "file" && argc > 2)
+    {
+        int max_depth = argc > 3 ? std::atoi(argv[3]) : 0;
+        perft_file(argv[2], max_depth);
+        return 0;
+    }
+    if (command == "batch")
+    {
+        unsigned threads = argc > 2 ? std::atoi(argv[2]) : default_thread_count();
+        if (argc > 3)
+        {
+            int max_depth = argc > 4 ? std::atoi(argv[4]) : 0;
+            perft_batch_file(argv[3], threads, max_depth);
+        }
+        else
+        {
+            perft_batch(threads);
+        }
+        return 0;
+    }
+    if (command == "divide" && argc > 3)
+    {
+        std::string output = argc > 4 ? argv[4] : "";
+        perft_divide(argv[2], std::atoi(argv[3]), output);
+        return 0;
+    }
+    if (command == "checkpoint" && argc > 4)
+    {
+        unsigned threads = argc > 5 ? std::atoi(argv[5]) : default_thread_count();
+        size_t hash_megabytes = argc > 6 ? std::atoi(argv[6]) : 0;
+        perft_checkpointed(argv[2], std::atoi(argv[3]), argv[4], threads, hash_megabytes);
+        return 0;
+    }
+    if (command == "bench")
+    {
+        // bench [output.json] [baseline.json] [threshold %] [runs]
+        std::string output = argc > 2 && std::string(argv[2]) != "-" ? argv[2] : "";
+        std::string baseline = argc > 3 ? argv[3] : "";
+        double threshold = argc > 4 ? std::atof(argv[4]) : 5.0;
+        int runs = argc > 5 ? std::atoi(argv[5]) : 3;
+        return perft_bench(output, baseline, threshold, runs);
+    }
+    if (command == "sliders")
+    {
+        compare_slider_backends(argc > 2 ? std::atoi(argv[2]) : 3);
+        return 0;
+    }
+    if (command == "copymake")
+    {
+        // copymake [max depth] [runs]
+        int max_depth = argc > 2 ? std::atoi(argv[2]) : 6;
+        int runs = argc > 3 ? std::atoi(argv[3]) : 1;
+        return compare_copy_make(max_depth, runs) ? 0 : 1;
+    }
+    if (command == "stats" && argc > 3)
+    {
+        unsigned threads = argc > 4 ? std::atoi(argv[4]) : default_thread_count();
+        perft_stats(argv[2], std::atoi(argv[3]), threads);
+        return 0;
+    }
+    if (command == "extensive")
+    {
+        unsigned threads = argc > 2 ? std::atoi(argv[2]) : default_thread_count();
+        size_t hash_megabytes = argc > 3 ? std::atoi(argv[3]) : 1024;
+        perft_extensive(threads, hash_megabytes);
+        return 0;
+    }
+    if (command == "coordinator" && argc > 4)
+    {
+        int split_ply = argc > 5 ? std::atoi(argv[5]) : 2;
+        unsigned local_workers = argc > 6 ? std::atoi(argv[6]) : 0;
+        int timeout_seconds = argc > 7 ? std::atoi(argv[7]) : 600;
+        perft_coordinator(argv[2], std::atoi(argv[3]), static_cast<uint16_t>(std::atoi(argv[4])), split_ply, local_workers, argv[0], timeout_seconds);
+        return 0;
+    }
+    if (command == "worker" && argc > 3)
+    {
+        unsigned threads = argc > 4 ? std::atoi(argv[4]) : default_thread_count();
+        size_t hash_megabytes = argc > 5 ? std::atoi(argv[5]) : 0;
+        perft_worker(argv[2], static_cast<uint16_t>(std::atoi(argv[3])), threads, hash_megabytes);
+        return 0;
+    }
+
     //speed();
     perft_fast();
     int z;
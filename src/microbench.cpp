@@ -0,0 +1,743 @@
+// Times the pieces of the move generation hot path separately so a change in
+// speed_test() can be traced to the slider lookups, MoveList or make_move.
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "batch_board.h"
+#include "batch_move_list.h"
+#include "bitboard.h"
+#include "board.h"
+#include "fen.h"
+#include "move.h"
+#include "move_generator.h"
+#include "move_list.h"
+#include "move_picker.h"
+#include "perf_counters.h"
+#include "perft.h"
+#include "perft_test.h"
+#include "slider_attacks.h"
+#include "slider_fill.h"
+
+namespace {
+
+using White = std::integral_constant<Player, Player::white>;
+using Black = std::integral_constant<Player, Player::black>;
+
+// Results are folded into the sink so the timed work cannot be optimized out.
+volatile uint64_t sink = 0ull;
+
+struct Corpus {
+  std::vector<std::string> fens;
+  std::vector<Board> white;
+  std::vector<Board> black;
+  std::vector<std::vector<Move>> white_moves;
+  std::vector<std::vector<Move>> black_moves;
+};
+
+template <Player Stm, GenType Type = GenType::legal>
+std::vector<Move> legal_moves(Board &board) {
+  std::vector<Move> moves;
+  MoveList<Stm, Type> move_list(board);
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    moves.push_back(move);
+  }
+  return moves;
+}
+
+// Every position from the perft suites, which covers pins, checks, castling,
+// en passant and promotions for both sides to move.
+Corpus create_corpus() {
+  Corpus corpus;
+  for (const auto *suite : {&perft_fast_vec, &speed_fen}) {
+    for (const auto &test : generate_tests(*suite)) {
+      corpus.fens.push_back(test.get_fen());
+      Board board = fen::create_board(test.get_fen());
+      if (board.player == Player::white) {
+        corpus.white_moves.push_back(legal_moves<Player::white>(board));
+        corpus.white.push_back(board);
+      } else {
+        corpus.black_moves.push_back(legal_moves<Player::black>(board));
+        corpus.black.push_back(board);
+      }
+    }
+  }
+  return corpus;
+}
+
+// Call f(board, moves, side) for every position in the corpus and return the
+// number of operations f reports.
+template <class F> uint64_t for_each_position(Corpus &corpus, F f) {
+  uint64_t operations = 0ull;
+  for (size_t i = 0; i < corpus.white.size(); ++i) {
+    operations += f(corpus.white[i], corpus.white_moves[i], White{});
+  }
+  for (size_t i = 0; i < corpus.black.size(); ++i) {
+    operations += f(corpus.black[i], corpus.black_moves[i], Black{});
+  }
+  return operations;
+}
+
+// The enemy sliders of a position, as seen by the side to move.
+struct SliderPosition {
+  uint64_t diagonal;
+  uint64_t orthogonal;
+  uint64_t occupancy;
+};
+
+template <Player Stm> SliderPosition enemy_sliders(const Board &board) {
+  return {board.get_piece_mask<!Stm, Piece::bishop, Piece::queen>(),
+          board.get_piece_mask<!Stm, Piece::rook, Piece::queen>(),
+          board.get_occupied_mask()};
+}
+
+template <Player Stm>
+void add_middlegames(Board &board, int depth,
+                     std::vector<SliderPosition> &positions) {
+  positions.push_back(enemy_sliders<Stm>(board));
+  if (depth == 0) {
+    return;
+  }
+  MoveList<Stm> move_list(board);
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    board.make_move<Stm>(move);
+    add_middlegames<!Stm>(board, depth - 1, positions);
+    board.unmake_move<Stm>(move);
+  }
+}
+
+// The corpus is mostly endgames, so the slider kernels are measured on the
+// positions with at least 20 pieces and everything two plies after them.
+std::vector<SliderPosition> create_middlegames(Corpus &corpus) {
+  std::vector<SliderPosition> positions;
+  for (auto &board : corpus.white) {
+    if (bitboard::pop_count(board.get_occupied_mask()) >= 20) {
+      add_middlegames<Player::white>(board, 2, positions);
+    }
+  }
+  for (auto &board : corpus.black) {
+    if (bitboard::pop_count(board.get_occupied_mask()) >= 20) {
+      add_middlegames<Player::black>(board, 2, positions);
+    }
+  }
+  return positions;
+}
+
+uint64_t magic_slider_attacks(const SliderPosition &position) {
+  uint64_t attacks = 0ull;
+  uint64_t diagonal = position.diagonal;
+  while (diagonal) {
+    attacks |= bishop_lookup(bitboard::pop_lsb(diagonal), position.occupancy);
+  }
+  uint64_t orthogonal = position.orthogonal;
+  while (orthogonal) {
+    attacks |= rook_lookup(bitboard::pop_lsb(orthogonal), position.occupancy);
+  }
+  return attacks;
+}
+
+struct BenchResult {
+  std::string name;
+  int repetitions;
+  uint64_t operations;
+  double median;
+  double variance;
+};
+
+// Run sweep repetitions times. Each sweep returns how many operations it
+// performed and the per operation time of each sweep is one sample.
+template <class Sweep>
+BenchResult measure(const std::string &name, int repetitions, Sweep sweep) {
+  std::vector<double> samples;
+  uint64_t operations = 0ull;
+  sweep(); // Warm the caches and branch predictors.
+  for (int i = 0; i < repetitions; ++i) {
+    Clock clock;
+    operations = sweep();
+    double nanoseconds = static_cast<double>(clock.elapsed_nanoseconds());
+    samples.push_back(nanoseconds / std::max<uint64_t>(operations, 1ull));
+  }
+
+  double mean = 0.0;
+  for (double sample : samples) {
+    mean += sample / samples.size();
+  }
+  double variance = 0.0;
+  for (double sample : samples) {
+    variance += (sample - mean) * (sample - mean);
+  }
+  variance /= std::max<size_t>(samples.size() - 1, 1);
+
+  std::sort(samples.begin(), samples.end());
+  size_t middle = samples.size() / 2;
+  double median = samples.size() % 2 == 1
+                      ? samples[middle]
+                      : (samples[middle - 1] + samples[middle]) / 2.0;
+  return {name, repetitions, operations, median, variance};
+}
+
+void print_result(const BenchResult &result) {
+  std::cout << std::left << std::setw(40) << result.name << std::right
+            << std::setw(8) << result.repetitions << std::setw(12)
+            << result.operations << std::fixed << std::setprecision(2)
+            << std::setw(14) << result.median << std::setw(14)
+            << result.variance << '\n';
+}
+
+bool move_less(const Move &first, const Move &second) {
+  return first.data < second.data;
+}
+
+// The corpus positions and every position one ply after them, for the batch
+// generator.
+std::vector<Board> create_bulk_positions(Corpus &corpus) {
+  std::vector<Board> positions;
+  for_each_position(corpus,
+                    [&](Board &board, const std::vector<Move> &moves,
+                        auto side) {
+                      constexpr Player stm = decltype(side)::value;
+                      positions.push_back(board);
+                      for (Move move : moves) {
+                        board.make_move<stm>(move);
+                        positions.push_back(board);
+                        positions.back().unmake_stack.clear();
+                        board.unmake_move<stm>(move);
+                      }
+                      return 0ull;
+                    });
+  return positions;
+}
+
+template <size_t Lanes>
+std::vector<BatchBoard<Lanes>> create_batches(const std::vector<Board> &boards) {
+  std::vector<BatchBoard<Lanes>> batches(1);
+  for (const auto &board : boards) {
+    if (batches.back().full()) {
+      batches.emplace_back();
+    }
+    batches.back().push(board);
+  }
+  return batches;
+}
+
+std::vector<Move> sorted_legal_moves(Board &board) {
+  std::vector<Move> moves = board.player == Player::white
+                                ? legal_moves<Player::white>(board)
+                                : legal_moves<Player::black>(board);
+  std::sort(moves.begin(), moves.end(), move_less);
+  return moves;
+}
+
+// True if every lane of every batch has the moves of MoveList.
+template <size_t Lanes>
+bool batch_matches(std::vector<Board> &boards,
+                   const std::vector<BatchBoard<Lanes>> &batches) {
+  for (size_t i = 0; i < boards.size(); ++i) {
+    BatchMoveList<Lanes> move_list(batches[i / Lanes]);
+    std::vector<Move> moves(move_list.begin(i % Lanes),
+                            move_list.end(i % Lanes));
+    std::sort(moves.begin(), moves.end(), move_less);
+    if (moves != sorted_legal_moves(boards[i])) {
+      std::cout << "Batch of " << Lanes << " moves differ from MoveList in "
+                << fen::to_fen(boards[i]) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// True if Board::is_legal accepts exactly the moves of MoveList, trying
+// every pair of squares with every move type.
+template <Player Stm> bool is_legal_matches(Board &board) {
+  const std::vector<Move> legal = sorted_legal_moves(board);
+  for (int from = 0; from < 64; ++from) {
+    for (int to = 0; to < 64; ++to) {
+      for (MoveType type :
+           {MoveType::normal, MoveType::double_push, MoveType::castle,
+            MoveType::en_passant, MoveType::knight_promotion,
+            MoveType::bishop_promotion, MoveType::rook_promotion,
+            MoveType::queen_promotion}) {
+        const Move move(from, to, type);
+        if (board.is_legal<Stm>(move) !=
+            std::binary_search(legal.begin(), legal.end(), move, move_less)) {
+          std::cout << "Board::is_legal is wrong for " << move << " in "
+                    << fen::to_fen(board) << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// True if MovePicker returns every legal move once, starting with a legal
+// hash move. The killers are taken from another position, so some of them
+// are illegal.
+template <Player Stm>
+bool picker_matches(Board &board, Move hash_move, const Killers &killers) {
+  MovePicker<Stm> picker(board, hash_move, killers);
+  std::vector<Move> moves;
+  for (Move move = picker.next(); move != null_move; move = picker.next()) {
+    moves.push_back(move);
+  }
+  const bool hash_first =
+      !board.is_legal<Stm>(hash_move) || moves.front() == hash_move;
+  std::sort(moves.begin(), moves.end(), move_less);
+  if (!hash_first || moves != sorted_legal_moves(board)) {
+    std::cout << "MovePicker moves differ from MoveList in "
+              << fen::to_fen(board) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// True if the captures and quiets of MoveList are its legal moves split by
+// kind, its evasions are the legal moves in check and none otherwise, and the
+// count and destination masks agree with the legal moves.
+template <Player Stm> bool gen_types_match(Board &board) {
+  std::vector<Move> captures = legal_moves<Stm, GenType::captures>(board);
+  std::vector<Move> quiets = legal_moves<Stm, GenType::quiets>(board);
+  std::vector<Move> evasions = legal_moves<Stm, GenType::evasions>(board);
+  auto is_tactical = [&board](const Move &move) {
+    return move.is_promotion() || move.type() == MoveType::en_passant ||
+           board.get_piece(move.to()) != Piece::none;
+  };
+  const std::vector<Move> legal = sorted_legal_moves(board);
+  std::vector<Move> split = captures;
+  split.insert(split.end(), quiets.begin(), quiets.end());
+  std::sort(split.begin(), split.end(), move_less);
+  std::sort(evasions.begin(), evasions.end(), move_less);
+  const bool in_check = board.get_attackers<!Stm>(board.get_king_square<Stm>(),
+                                                  board.get_occupied_mask());
+  std::array<uint64_t, 64> destinations{};
+  for (const Move &move : legal) {
+    destinations[move.from()] |= bitboard::to_bitboard(move.to());
+  }
+  MoveList<Stm, GenType::destinations> masks(board);
+  bool masks_match = masks.size() == legal.size();
+  for (int from = 0; from < 64; ++from) {
+    masks_match &= masks.destinations(from) == destinations[from];
+  }
+  if (split != legal || !masks_match ||
+      MoveList<Stm, GenType::count>(board).size() != legal.size() ||
+      !std::all_of(captures.begin(), captures.end(), is_tactical) ||
+      std::any_of(quiets.begin(), quiets.end(), is_tactical) ||
+      evasions != (in_check ? legal : std::vector<Move>())) {
+    std::cout << "MoveList generation types differ from the legal moves in "
+              << fen::to_fen(board) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// True if the boards have the same pieces, side to move, en passant square,
+// castle rights and key.
+bool same_state(const Board &first, const Board &second) {
+  return first.pieces == second.pieces && first.occupancy == second.occupancy &&
+         first.board == second.board && first.player == second.player &&
+         first.en_passant == second.en_passant &&
+         first.castle_rights == second.castle_rights &&
+         first.key == second.key;
+}
+
+// True if make_move reaches the position its FEN describes, key included, for
+// every legal move, and unmake_move restores the board.
+template <Player Stm> bool make_unmake_matches(Board &board) {
+  const Board before = board;
+  for (const Move &move : sorted_legal_moves(board)) {
+    board.make_move<Stm>(move);
+    const bool made = same_state(board, fen::create_board(fen::to_fen(board)));
+    board.unmake_move<Stm>(move);
+    if (!made || !same_state(board, before) ||
+        board.unmake_stack.size() != before.unmake_stack.size()) {
+      std::cout << "make_move/unmake_move is wrong for " << move << " in "
+                << fen::to_fen(before) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// True if check(board, index, side) passes for every board, stopping at the
+// first that fails.
+template <class F> bool all_boards_pass(std::vector<Board> &boards, F check) {
+  for (size_t i = 0; i < boards.size(); ++i) {
+    const bool passed = boards[i].player == Player::white
+                            ? check(boards[i], i, White{})
+                            : check(boards[i], i, Black{});
+    if (!passed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The MovePicker check of every board, with a legal hash move and the
+// killers of the board before it.
+bool picker_checks_pass(std::vector<Board> &boards) {
+  Killers killers = {null_move, null_move};
+  return all_boards_pass(boards, [&killers](Board &board, size_t i,
+                                            auto side) {
+    const std::vector<Move> moves = sorted_legal_moves(board);
+    const Move hash_move = moves.empty() ? null_move : moves[i % moves.size()];
+    const bool passed =
+        picker_matches<decltype(side)::value>(board, hash_move, killers);
+    if (moves.size() > 1) {
+      killers = {moves[0], moves[moves.size() / 2]};
+    }
+    return passed;
+  });
+}
+
+template <Player Stm, GenType Type = GenType::legal>
+uint64_t construct_move_list(const Board &board) {
+  MoveList<Stm, Type> move_list(board);
+  sink += move_list.size();
+  return 1ull;
+}
+
+// Construct a MoveList of generation type Type for every corpus position,
+// passes times per sample.
+template <GenType Type> auto gen_type_sweep(Corpus &corpus, int passes) {
+  return [&corpus, passes] {
+    uint64_t operations = 0ull;
+    for (int pass = 0; pass < passes; ++pass) {
+      operations += for_each_position(
+          corpus, [](Board &board, const std::vector<Move> &, auto side) {
+            return construct_move_list<decltype(side)::value, Type>(board);
+          });
+    }
+    return operations;
+  };
+}
+
+template <Player Stm>
+uint64_t generate_pinned(const Board &board, MoveList<Stm> &move_list) {
+  move_list.clear();
+  move_list.generate_pinned_piece_moves_again(board);
+  sink += move_list.size();
+  return 1ull;
+}
+
+// The first move of a node whose hash move is legal.
+template <Player Stm>
+uint64_t pick_hash_move(const Board &board, const std::vector<Move> &moves) {
+  MovePicker<Stm> picker(board, moves.empty() ? null_move : moves.front());
+  sink += picker.next().to();
+  return 1ull;
+}
+
+template <Player Stm> uint64_t pick_all_moves(const Board &board) {
+  MovePicker<Stm> picker(board);
+  for (Move move = picker.next(); move != null_move; move = picker.next()) {
+    sink += move.to();
+  }
+  return 1ull;
+}
+
+template <Player Stm>
+uint64_t make_unmake(Board &board, const std::vector<Move> &moves) {
+  for (Move move : moves) {
+    board.make_move<Stm>(move);
+    board.unmake_move<Stm>(move);
+  }
+  sink += board.key;
+  return moves.size();
+}
+
+template <Piece P> uint64_t slider_lookups(const Board &board) {
+  uint64_t occupancy = board.get_occupied_mask();
+  uint64_t attacks = 0ull;
+  for (int square = 0; square < 64; ++square) {
+    attacks ^= attacks_from<P>(square, occupancy);
+  }
+  sink += attacks;
+  return 64ull;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  move_generator_init();
+
+  int repetitions = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 31;
+  // Passes over the corpus per sample, so each sample runs for a few
+  // milliseconds instead of close to the clock resolution.
+  const int passes = 200;
+  Corpus corpus = create_corpus();
+
+  // Each component is checked against MoveList on the corpus and every
+  // position one ply after it before anything is timed.
+  std::vector<Board> bulk = create_bulk_positions(corpus);
+  const std::vector<BatchBoard<4>> batches4 = create_batches<4>(bulk);
+  const std::vector<BatchBoard<8>> batches8 = create_batches<8>(bulk);
+  if (!all_boards_pass(bulk,
+                       [](Board &board, size_t, auto side) {
+                         return is_legal_matches<decltype(side)::value>(board);
+                       }) ||
+      !all_boards_pass(bulk,
+                       [](Board &board, size_t, auto side) {
+                         return gen_types_match<decltype(side)::value>(board);
+                       }) ||
+      !all_boards_pass(bulk,
+                       [](Board &board, size_t, auto side) {
+                         return make_unmake_matches<decltype(side)::value>(
+                             board);
+                       }) ||
+      !picker_checks_pass(bulk) || !batch_matches(bulk, batches4) ||
+      !batch_matches(bulk, batches8)) {
+    return 1;
+  }
+
+  // Move lists for the pinned piece benchmark are built once and reset
+  // before every call.
+  std::vector<MoveList<Player::white>> white_lists;
+  std::vector<MoveList<Player::black>> black_lists;
+  for (const auto &board : corpus.white) {
+    white_lists.emplace_back(board);
+  }
+  for (const auto &board : corpus.black) {
+    black_lists.emplace_back(board);
+  }
+
+  // Operations run inside each hardware counter region, for per op rates.
+  uint64_t move_list_operations = 0ull;
+  uint64_t make_unmake_operations = 0ull;
+
+  std::vector<BenchResult> results;
+  results.push_back(measure("MoveList construction", repetitions, [&] {
+    PerfScope scope(PerfRegion::move_list);
+    uint64_t operations = 0ull;
+    for (int pass = 0; pass < passes; ++pass) {
+      operations += for_each_position(
+          corpus, [](Board &board, const std::vector<Move> &, auto side) {
+            return construct_move_list<decltype(side)::value>(board);
+          });
+    }
+    move_list_operations += operations;
+    return operations;
+  }));
+
+  results.push_back(measure("MoveList construction (captures)", repetitions,
+                            gen_type_sweep<GenType::captures>(corpus, passes)));
+  results.push_back(measure("MoveList construction (count)", repetitions,
+                            gen_type_sweep<GenType::count>(corpus, passes)));
+  results.push_back(
+      measure("MoveList construction (destinations)", repetitions,
+              gen_type_sweep<GenType::destinations>(corpus, passes)));
+  results.push_back(measure("MoveList construction (quiets)", repetitions,
+                            gen_type_sweep<GenType::quiets>(corpus, passes)));
+
+  // A cutoff on the hash move against visiting every move with the picker.
+  results.push_back(measure("MovePicker hash move", repetitions, [&] {
+    uint64_t operations = 0ull;
+    for (int pass = 0; pass < passes; ++pass) {
+      operations += for_each_position(
+          corpus, [](Board &board, const std::vector<Move> &moves, auto side) {
+            return pick_hash_move<decltype(side)::value>(board, moves);
+          });
+    }
+    return operations;
+  }));
+  results.push_back(measure("MovePicker all moves", repetitions, [&] {
+    uint64_t operations = 0ull;
+    for (int pass = 0; pass < passes; ++pass) {
+      operations += for_each_position(
+          corpus, [](Board &board, const std::vector<Move> &, auto side) {
+            return pick_all_moves<decltype(side)::value>(board);
+          });
+    }
+    return operations;
+  }));
+
+  results.push_back(
+      measure("generate_pinned_piece_moves_again", repetitions, [&] {
+        uint64_t operations = 0ull;
+        for (int pass = 0; pass < passes; ++pass) {
+          for (size_t i = 0; i < corpus.white.size(); ++i) {
+            operations += generate_pinned(corpus.white[i], white_lists[i]);
+          }
+          for (size_t i = 0; i < corpus.black.size(); ++i) {
+            operations += generate_pinned(corpus.black[i], black_lists[i]);
+          }
+        }
+        return operations;
+      }));
+
+  // Slider lookups with each backend the CPU supports.
+  const SliderBackend selected = slider_backend;
+  for (SliderBackend backend : slider_backends) {
+    if (!set_slider_backend(backend)) {
+      continue;
+    }
+    const std::string name = to_string(backend);
+    results.push_back(measure("bishop attacks (" + name + ")", repetitions,
+                              [&] {
+                                uint64_t operations = 0ull;
+                                for (int pass = 0; pass < passes; ++pass) {
+                                  operations += for_each_position(
+                                      corpus, [](Board &board,
+                                                 const std::vector<Move> &,
+                                                 auto) {
+                                        return slider_lookups<Piece::bishop>(
+                                            board);
+                                      });
+                                }
+                                return operations;
+                              }));
+    results.push_back(measure("rook attacks (" + name + ")", repetitions,
+                              [&] {
+                                uint64_t operations = 0ull;
+                                for (int pass = 0; pass < passes; ++pass) {
+                                  operations += for_each_position(
+                                      corpus, [](Board &board,
+                                                 const std::vector<Move> &,
+                                                 auto) {
+                                        return slider_lookups<Piece::rook>(
+                                            board);
+                                      });
+                                }
+                                return operations;
+                              }));
+  }
+  set_slider_backend(selected);
+
+  // Attacks of all enemy sliders, one lookup per piece against the
+  // Kogge-Stone kernels. The kernels are checked against the lookups first.
+  const std::vector<SliderPosition> middlegames = create_middlegames(corpus);
+  for (const auto &position : middlegames) {
+    uint64_t expected = magic_slider_attacks(position);
+    if (slider_rays_scalar(position.diagonal, position.orthogonal,
+                           position.occupancy)
+                .attacks != expected ||
+        slider_rays(position.diagonal, position.orthogonal, position.occupancy)
+                .attacks != expected) {
+      std::cout << "Kogge-Stone attacks differ from the lookups." << std::endl;
+      return 1;
+    }
+  }
+  auto slider_sweep = [&](auto kernel) {
+    return [&middlegames, kernel] {
+      uint64_t attacks = 0ull;
+      for (int pass = 0; pass < passes / 20; ++pass) {
+        for (const auto &position : middlegames) {
+          attacks ^= kernel(position);
+        }
+      }
+      sink += attacks;
+      return static_cast<uint64_t>(passes / 20 * middlegames.size());
+    };
+  };
+  results.push_back(measure(
+      "enemy slider attacks (lookups)", repetitions,
+      slider_sweep([](const SliderPosition &position) {
+        return magic_slider_attacks(position);
+      })));
+  results.push_back(measure(
+      "enemy slider attacks (Kogge-Stone)", repetitions,
+      slider_sweep([](const SliderPosition &position) {
+        return slider_rays_scalar(position.diagonal, position.orthogonal,
+                                  position.occupancy)
+            .attacks;
+      })));
+#if SLIDER_AVX2_AVAILABLE
+  if (cpu_supports_avx2()) {
+    results.push_back(measure(
+        "enemy slider attacks (Kogge-Stone AVX2)", repetitions,
+        slider_sweep([](const SliderPosition &position) {
+          return slider_rays_avx2(position.diagonal, position.orthogonal,
+                                  position.occupancy)
+              .attacks;
+        })));
+  }
+#endif
+
+  // Bulk generation over independent positions, looping over MoveList
+  // against the batch generator. The batches are filled once, as a bulk
+  // workload would store its positions.
+  results.push_back(measure("bulk positions (MoveList)", repetitions, [&] {
+    for (int pass = 0; pass < passes / 20; ++pass) {
+      for (const auto &board : bulk) {
+        if (board.player == Player::white) {
+          construct_move_list<Player::white>(board);
+        } else {
+          construct_move_list<Player::black>(board);
+        }
+      }
+    }
+    return static_cast<uint64_t>(passes / 20 * bulk.size());
+  }));
+  auto batch_sweep = [&](const auto &batches) {
+    return [&] {
+      using Batch = typename std::decay_t<decltype(batches)>::value_type;
+      for (int pass = 0; pass < passes / 20; ++pass) {
+        for (const auto &batch : batches) {
+          BatchMoveList<Batch::lanes> move_list(batch);
+          sink += move_list.size(0);
+        }
+      }
+      return static_cast<uint64_t>(passes / 20 * bulk.size());
+    };
+  };
+  results.push_back(
+      measure("bulk positions (batch of 4)", repetitions, batch_sweep(batches4)));
+  results.push_back(
+      measure("bulk positions (batch of 8)", repetitions, batch_sweep(batches8)));
+
+  results.push_back(measure("make_move/unmake_move pair", repetitions, [&] {
+    PerfScope scope(PerfRegion::make_unmake);
+    uint64_t operations = 0ull;
+    for (int pass = 0; pass < passes; ++pass) {
+      operations += for_each_position(
+          corpus,
+          [](Board &board, const std::vector<Move> &moves, auto side) {
+            return make_unmake<decltype(side)::value>(board, moves);
+          });
+    }
+    make_unmake_operations += operations;
+    return operations;
+  }));
+
+  results.push_back(measure("fen::create_board", repetitions, [&] {
+    uint64_t operations = 0ull;
+    for (int pass = 0; pass < passes / 10; ++pass) {
+      for (const auto &fen : corpus.fens) {
+        sink += fen::create_board(fen).key;
+        operations++;
+      }
+    }
+    return operations;
+  }));
+
+  std::cout << corpus.fens.size() << " positions, " << passes
+            << " passes per sample, " << middlegames.size()
+            << " middlegame positions for the slider kernels\n\n"
+            << std::left << std::setw(40) << "benchmark" << std::right
+            << std::setw(8) << "reps" << std::setw(12) << "ops/rep"
+            << std::setw(14) << "median ns/op" << std::setw(14)
+            << "variance" << '\n';
+  for (const auto &result : results) {
+    print_result(result);
+  }
+  std::cout << '\n';
+  for (const auto &result : results) {
+    if (result.name.compare(0, 14, "bulk positions") == 0) {
+      std::cout << std::left << std::setw(40) << result.name << std::right
+                << std::setw(14) << std::setprecision(0)
+                << 1e9 / result.median << " positions/s\n";
+    }
+  }
+#if PERF_COUNTERS_ENABLED
+  std::cout << "\nMoveList construction\n";
+  print_perf_counts(PerfRegion::move_list, move_list_operations, "op");
+  std::cout << "make_move/unmake_move pair\n";
+  print_perf_counts(PerfRegion::make_unmake, make_unmake_operations, "op");
+#endif
+  return 0;
+}
@@ -1,21 +1,80 @@
 #ifndef MOVE_H
 #define MOVE_H
 
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <string>
 
+#include "piece.h"
+
+// What a move does besides moving a piece, set by the generator so make_move
+// can switch on it instead of working it out from the pieces and squares.
+// Promotions have bit 3 set and the promoted piece in the low two bits.
+enum class MoveType : uint16_t
+{
+    normal,
+    double_push,
+    castle,
+    en_passant,
+    knight_promotion = 8,
+    bishop_promotion,
+    rook_promotion,
+    queen_promotion
+};
+
+inline constexpr MoveType promotion_type(Piece piece)
+{
+    return static_cast<MoveType>(static_cast<int>(MoveType::knight_promotion) + piece - Piece::knight);
+}
+
+// A move packed into 16 bits: the from square in bits 0-5, the to square in
+// bits 6-11 and the MoveType in bits 12-15.
 struct Move
 {
-    int from;
-    int to;
-    Piece promotion;
+    uint16_t data;
+
+    Move() = default;
+
+    constexpr Move(int from, int to, MoveType type = MoveType::normal)
+        : data(static_cast<uint16_t>(from | to << 6 | static_cast<int>(type) << 12))
+    {}
+
+    constexpr int from() const
+    {
+        return data & 63;
+    }
+
+    constexpr int to() const
+    {
+        return data >> 6 & 63;
+    }
+
+    constexpr MoveType type() const
+    {
+        return static_cast<MoveType>(data >> 12);
+    }
+
+    constexpr bool is_promotion() const
+    {
+        return (data & 0x8000) != 0;
+    }
+
+    // The promoted piece, Piece::none if the move is not a promotion.
+    constexpr Piece promotion() const
+    {
+        return is_promotion() ? static_cast<Piece>(Piece::knight + (data >> 12 & 3)) : Piece::none;
+    }
 };
 
-static const Move null_move = { 0, 0, Piece::none };
+static_assert(sizeof(Move) == 2, "Move must pack into 16 bits");
+
+static const Move null_move(0, 0);
 
 inline bool operator==(const Move& m1, const Move& m2)
 {
-    return m1.from == m2.from && m1.to == m2.to && m1.promotion == m2.promotion;
+    return m1.data == m2.data;
 }
 
 inline bool operator!=(const Move& m1, const Move& m2)
@@ -24,10 +83,22 @@ inline bool operator!=(const Move& m1, const Move& m2)
 }
 
 inline std::ostream& operator<<(std::ostream& o, const Move& move) {
-    o << static_cast<char>('h' - (move.from % 8)) << move.from / 8 + 1 << static_cast<char>('h' - (move.to % 8)) << move.to / 8 + 1;
+    o << static_cast<char>('h' - (move.from() % 8)) << move.from() / 8 + 1 << static_cast<char>('h' - (move.to() % 8)) << move.to() / 8 + 1;
+    // Promotions are written in the UCI style, e.g. e7e8q.
+    if (move.is_promotion())
+    {
+        o << " pnbrqk"[move.promotion()];
+    }
     return o;
 }
 
+inline std::string to_string(const Move& move)
+{
+    std::ostringstream oss;
+    oss << move;
+    return oss.str();
+}
+
 //inline std::ostream& operator<<(std::ostream& o, const Move& move)
 //{
 //    o << "<Move " << &move << " from: " << move.from << " to: " << move.to << " promotion: " << move.promotion << ">";
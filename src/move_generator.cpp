@@ -3,12 +3,56 @@
 #include "magic_moves.h"
 #include "piece.h"
 #include "player.h"
+#include "slider_attacks.h"
 
-static uint64_t pawn_moves[2][64];
-static uint64_t knight_moves[64];
-static uint64_t bishop_moves[64];
-static uint64_t rook_moves[64];
-static uint64_t king_moves[64];
+struct PseudoMoves {
+  uint64_t pawn_moves[2][64];
+  uint64_t knight_moves[64];
+  uint64_t king_moves[64];
+};
+
+// Moves of each piece on an empty board, generated at compile time.
+static constexpr PseudoMoves create_pseudo_moves() {
+  PseudoMoves moves{};
+  for (int square = 0; square < 64; ++square) {
+    const uint64_t mask = 1ull << square;
+    // Pawn moves.
+    moves.pawn_moves[static_cast<int>(Player::white)][square] =
+        (mask & ~bitboard::h_file) << 7 | (mask & ~bitboard::a_file) << 9 |
+        mask << 8;
+    moves.pawn_moves[static_cast<int>(Player::black)][square] =
+        (mask & ~bitboard::h_file) >> 9 | (mask & ~bitboard::a_file) >> 7 |
+        mask >> 8;
+    if (mask & bitboard::rank_2) {
+      moves.pawn_moves[static_cast<int>(Player::white)][square] |= mask << 16;
+    }
+    if (mask & bitboard::rank_7) {
+      moves.pawn_moves[static_cast<int>(Player::white)][square] |= mask >> 16;
+    }
+    // Knight moves.
+    moves.knight_moves[square] =
+        (mask & ~(bitboard::a_file | bitboard::b_file)) << 10 |
+        (mask & ~(bitboard::g_file | bitboard::h_file)) >> 10 |
+        (mask & ~(bitboard::a_file | bitboard::b_file)) >> 6 |
+        (mask & ~(bitboard::g_file | bitboard::h_file)) << 6 |
+        (mask & ~bitboard::a_file) >> 15 | (mask & ~bitboard::a_file) << 17 |
+        (mask & ~bitboard::h_file) << 15 | (mask & ~bitboard::h_file) >> 17;
+    // King moves.
+    moves.king_moves[square] =
+        (mask & ~bitboard::a_file) << 1 | (mask & ~bitboard::a_file) << 9 |
+        (mask & ~bitboard::a_file) >> 7 | mask << 8 | mask >> 8 |
+        (mask & ~bitboard::h_file) >> 1 | (mask & ~bitboard::h_file) << 7 |
+        (mask & ~bitboard::h_file) >> 9;
+  }
+  return moves;
+}
+
+static constexpr PseudoMoves pseudo_moves = create_pseudo_moves();
+static constexpr const auto &pawn_moves = pseudo_moves.pawn_moves;
+static constexpr const auto &knight_moves = pseudo_moves.knight_moves;
+static constexpr const auto &king_moves = pseudo_moves.king_moves;
+static constexpr const auto &bishop_moves = bitboard::bishop_attacks;
+static constexpr const auto &rook_moves = bitboard::rook_attacks;
 
 uint64_t pseudo_pawn_moves(Player player, int square) {
   return pawn_moves[static_cast<int>(player)][square];
@@ -48,39 +92,5 @@ template <Piece Stm> uint64_t slider_attacks(int square, uint64_t occupancy) {
 
 void move_generator_init() {
   initmagicmoves();
-
-  // Fill the pseudo move array.
-  for (int square = 0; square < 64; ++square) {
-    const uint64_t mask = bitboard::to_bitboard(square);
-    // Pawn moves.
-    pawn_moves[static_cast<int>(Player::white)][square] = (mask & ~bitboard::h_file) << 7 |
-                                        (mask & ~bitboard::a_file) << 9 |
-                                        mask << 8;
-    pawn_moves[static_cast<int>(Player::black)][square] = (mask & ~bitboard::h_file) >> 9 |
-                                        (mask & ~bitboard::a_file) >> 7 |
-                                        mask >> 8;
-    if (mask & bitboard::rank_2) {
-      pawn_moves[static_cast<int>(Player::white)][square] |= mask << 16;
-    }
-    if (mask & bitboard::rank_7) {
-      pawn_moves[static_cast<int>(Player::white)][square] |= mask >> 16;
-    }
-    // Knight moves.
-    knight_moves[square] =
-        (mask & ~(bitboard::a_file | bitboard::b_file)) << 10 |
-        (mask & ~(bitboard::g_file | bitboard::h_file)) >> 10 |
-        (mask & ~(bitboard::a_file | bitboard::b_file)) >> 6 |
-        (mask & ~(bitboard::g_file | bitboard::h_file)) << 6 |
-        (mask & ~bitboard::a_file) >> 15 | (mask & ~bitboard::a_file) << 17 |
-        (mask & ~bitboard::h_file) << 15 | (mask & ~bitboard::h_file) >> 17;
-    // Bishop moves.
-    bishop_moves[square] = Bmagic(static_cast<unsigned int>(square), 0ull);
-    rook_moves[square] = Rmagic(static_cast<unsigned int>(square), 0ull);
-    // King moves.
-    king_moves[square] =
-        (mask & ~bitboard::a_file) << 1 | (mask & ~bitboard::a_file) << 9 |
-        (mask & ~bitboard::a_file) >> 7 | mask << 8 | mask >> 8 |
-        (mask & ~bitboard::h_file) >> 1 | (mask & ~bitboard::h_file) << 7 |
-        (mask & ~bitboard::h_file) >> 9;
-  }
+  slider_attacks_init();
 }
@@ -1,6 +1,7 @@
 #ifndef MOVE_GENERATOR_H
 #define MOVE_GENERATOR_H
 
+#include <climits>
 #include <iostream>
 #include <string>
 
@@ -9,6 +10,7 @@
 #include "piece.h"
 #include "bitboard.h"
 #include "board.h"
+#include "slider_attacks.h"
 
 uint64_t pseudo_pawn_moves(Player player, int square);
 uint64_t pseudo_pawn_quiets(Player player, int square);
@@ -58,17 +60,17 @@ public:
             if ((pseudo_bishop_moves(square) & valid) == 0u) {
                 return 0u;
             }
-            return Bmagic(square, _occupancy) & valid;
+            return bishop_lookup(square, _occupancy) & valid;
         case Piece::rook:
             if ((pseudo_rook_moves(square) & valid) == 0u) {
                 return 0u;
             }
-            return Rmagic(square, _occupancy) & valid;
+            return rook_lookup(square, _occupancy) & valid;
         case Piece::queen:
             if ((pseudo_queen_moves(square) & valid) == 0u) {
                 return 0u;
             }
-            return Qmagic(square, _occupancy) & valid;
+            return queen_lookup(square, _occupancy) & valid;
         case Piece::king:
             return pseudo_king_moves(square) & valid;
         }
@@ -131,17 +133,17 @@ template<> inline uint64_t attacks_from<Piece::knight>(int square, uint64_t occu
 
 template<> inline uint64_t attacks_from<Piece::bishop>(int square, uint64_t occupancy)
 {
-    return Bmagic(square, occupancy);
+    return bishop_lookup(square, occupancy);
 }
 
 template<> inline uint64_t attacks_from<Piece::rook>(int square, uint64_t occupancy)
 {
-    return Rmagic(square, occupancy);
+    return rook_lookup(square, occupancy);
 }
 
 template<> inline uint64_t attacks_from<Piece::queen>(int square, uint64_t occupancy)
 {
-    return Qmagic(square, occupancy);
+    return queen_lookup(square, occupancy);
 }
 
 template<> inline uint64_t attacks_from<Piece::king>(int square, uint64_t occupancy)
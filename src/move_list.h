@@ -10,88 +10,158 @@
 #include "magic_moves.h"
 #include "move.h"
 #include "move_generator.h"
+#include "move_serialize.h"
 
-template <Player Stm> class MoveList {
+// Which legal moves MoveList generates.
+//   legal         every legal move
+//   captures      captures, en passant and every promotion
+//   quiets        the other legal moves, castling included
+//   evasions      every legal move of a side in check, none otherwise
+//   count         every legal move, counted instead of stored
+//   destinations  every legal move, stored as a destination mask per origin
+// Captures and quiets split the legal moves between them, so a search can
+// generate the quiets only once the captures failed to cut off. Count and
+// destinations never write a Move: size() is the number of legal moves and
+// destinations(from) the squares the piece on from can move to.
+enum class GenType { legal, captures, quiets, evasions, count, destinations };
+
+// BoardType is Board or any type with the same accessors, such as Position.
+template <Player Stm, GenType Type = GenType::legal, class BoardType = Board>
+class MoveList {
 private:
+  // Destinations of the non pawn moves of Type. Pawn moves are split in
+  // generate_pawn_pushes and generate_pawn_attacks instead, as a push can be
+  // a promotion.
+  static uint64_t targets(const BoardType &board) {
+    switch (Type) {
+    case GenType::captures:
+      return board.template get_occupied_mask<!Stm>();
+    case GenType::quiets:
+      return ~board.get_occupied_mask();
+    default:
+      return ~0ull;
+    }
+  }
+
+  // Destinations of pawn pushes of Type.
+  static constexpr uint64_t push_targets =
+      Type == GenType::captures ? PlayerTraits<Stm>::promotion_mask
+      : Type == GenType::quiets ? ~PlayerTraits<Stm>::promotion_mask
+                                : ~0ull;
+
   std::array<Move, 255> _move_list;
+  // Only written by GenType::destinations.
+  std::array<uint64_t, 64> _destinations;
   size_t _size;
   MoveGen<Stm> _gen;
   uint64_t _checkers;
   uint64_t _attacks;
   uint64_t _pinned;
   uint64_t _contact_check;
+  uint64_t _targets;
 
 public:
-  MoveList(const Board &board)
+  MoveList(const BoardType &board)
       : _size(0), _gen(board.get_occupied_mask()), _checkers(0u), _attacks(0u),
-        _pinned(0u), _contact_check(0u) {
+        _pinned(0u), _contact_check(0u), _targets(targets(board)) {
+    if constexpr (Type == GenType::destinations) {
+      _destinations.fill(0u);
+    }
 
     generate_pinned_piece_moves_again(board);
-    uint64_t valid_moves = ~board.get_occupied_mask<Stm>();
-    push_moves<Piece::king>(board, ~board.get_occupied_mask<Stm>() & ~_attacks);
+    if (Type == GenType::evasions && _checkers == 0u) {
+      // Drop the moves of pinned pieces.
+      discard_moves();
+      return;
+    }
+    uint64_t valid_moves = ~board.template get_occupied_mask<Stm>();
+    push_moves<Piece::king>(board,
+                            ~board.template get_occupied_mask<Stm>() &
+                                ~_attacks & _targets);
     if (_checkers != 0u) {
       if (bitboard::pop_count(_checkers) == 2) {
         return;
       }
-      valid_moves = _checkers | bitboard::between(board.get_king_square<Stm>(),
-                                                  bitboard::get_lsb(_checkers));
-    } else {
+      valid_moves =
+          _checkers | bitboard::between(board.template get_king_square<Stm>(),
+                                        bitboard::get_lsb(_checkers));
+    } else if (Type != GenType::captures && Type != GenType::evasions) {
       generate_castle_moves(board);
     }
 
     // Normal Moves.
     all_pawn_moves(board, valid_moves);
-    push_moves<Piece::knight>(board, valid_moves);
-    push_moves<Piece::bishop>(board, valid_moves);
-    push_moves<Piece::rook>(board, valid_moves);
+    push_moves<Piece::knight>(board, valid_moves & _targets);
+    push_moves<Piece::bishop>(board, valid_moves & _targets);
+    push_moves<Piece::rook>(board, valid_moves & _targets);
   }
 
   size_t size() const { return _size; }
 
+  uint64_t destinations(int from) const {
+    static_assert(Type == GenType::destinations,
+                  "Only GenType::destinations keeps destination masks");
+    return _destinations[from];
+  }
+
+  // Forget the generated moves and attack state so the generation steps can
+  // be run again against the same board.
+  void clear() {
+    discard_moves();
+    _checkers = 0u;
+    _attacks = 0u;
+    _pinned = 0u;
+    _contact_check = 0u;
+  }
+
   Move get_move() {
+    static_assert(Type != GenType::count && Type != GenType::destinations,
+                  "Counted moves are not stored");
     if (_size > 0) {
       return _move_list[--_size];
     }
     return null_move;
   }
 
-  void push_king_moves(const Board &board) {
-    const int square = board.get_king_square<Stm>();
-    const uint64_t valid = ~board.get_occupied_mask<Stm>() & ~_attacks;
+  void push_king_moves(const BoardType &board) {
+    const int square = board.template get_king_square<Stm>();
+    const uint64_t valid = ~board.template get_occupied_mask<Stm>() & ~_attacks;
 
     if (_checkers != 0u) {
       // Empty the move list when if in check.
-      _size = 0;
+      discard_moves();
     } else {
       // Make castling moves when not in check.
-      if (board.can_castle_kingside<Stm>(_attacks)) {
-        _move_list[_size++] = {square, square - 2, Piece::none};
+      if (board.template can_castle_kingside<Stm>(_attacks)) {
+        push_move(Move(square, square - 2, MoveType::castle));
       }
-      if (board.can_castle_queenside<Stm>(_attacks)) {
-        _move_list[_size++] = {square, square + 2, Piece::none};
+      if (board.template can_castle_queenside<Stm>(_attacks)) {
+        push_move(Move(square, square + 2, MoveType::castle));
       }
     }
   }
 
-  void generate_pinned_piece_moves_again(const Board &board) {
-    const int king_square = board.get_king_square<Stm>();
+  void generate_pinned_piece_moves_again(const BoardType &board) {
+    const int king_square = board.template get_king_square<Stm>();
     // Set the attack mask.
     _checkers |= pawn_attacks(Stm, king_square) &
-                 board.get_piece_mask<!Stm, Piece::pawn>();
+                 board.template get_piece_mask<!Stm, Piece::pawn>();
     _checkers |= pseudo_knight_moves(king_square) &
-                 board.get_piece_mask<!Stm, Piece::knight>();
+                 board.template get_piece_mask<!Stm, Piece::knight>();
     _contact_check |= _checkers;
-    _attacks |= pawn_attacks(!Stm, board.get_piece_mask<!Stm, Piece::pawn>());
-    uint64_t knights = board.get_piece_mask<!Stm, Piece::knight>();
+    _attacks |= pawn_attacks(
+        !Stm, board.template get_piece_mask<!Stm, Piece::pawn>());
+    uint64_t knights = board.template get_piece_mask<!Stm, Piece::knight>();
     while (knights) {
       _attacks |= pseudo_knight_moves(bitboard::pop_lsb(knights));
     }
 
     // Remove the king from occupancy.
     const uint64_t occupancy_wo_king =
-        board.get_occupied_mask() ^ board.get_piece_mask<Stm, Piece::king>();
+        board.get_occupied_mask() ^
+        board.template get_piece_mask<Stm, Piece::king>();
     uint64_t sliders =
-        board.get_piece_mask<!Stm, Piece::bishop, Piece::queen>();
+        board.template get_piece_mask<!Stm, Piece::bishop, Piece::queen>();
     while (sliders) {
       int slider_square = bitboard::pop_lsb(sliders);
       uint64_t slider_attacks =
@@ -105,7 +175,7 @@ public:
                    bitboard::between_diagonal(slider_square, king_square) &
                    occupancy_wo_king) == 1 &&
                (bitboard::between_diagonal(slider_square, king_square) &
-                board.get_occupied_mask<Stm>()) != 0u) {
+                board.template get_occupied_mask<Stm>()) != 0u) {
         int pinned_square = bitboard::get_lsb(
             bitboard::between_diagonal(slider_square, king_square) &
             occupancy_wo_king);
@@ -117,19 +187,17 @@ public:
                                 bitboard::to_bitboard(slider_square));
         } else if (pinned == Piece::bishop || pinned == Piece::queen) {
           uint64_t moves =
-              (bitboard::between_diagonal(king_square, slider_square) |
-               bitboard::to_bitboard(slider_square)) ^
-              bitboard::to_bitboard(pinned_square);
-          while (moves) {
-            _move_list[_size++] = {pinned_square, bitboard::pop_lsb(moves),
-                                   Piece::none};
-          }
+              ((bitboard::between_diagonal(king_square, slider_square) |
+                bitboard::to_bitboard(slider_square)) ^
+               bitboard::to_bitboard(pinned_square)) &
+              _targets;
+          push_destinations(pinned_square, moves);
         }
       }
       _attacks |= slider_attacks;
     }
 
-    sliders = board.get_piece_mask<!Stm, Piece::rook, Piece::queen>();
+    sliders = board.template get_piece_mask<!Stm, Piece::rook, Piece::queen>();
     while (sliders) {
       int slider_square = bitboard::pop_lsb(sliders);
       uint64_t slider_attacks =
@@ -143,7 +211,7 @@ public:
                    bitboard::between_horizonal(slider_square, king_square) &
                    occupancy_wo_king) == 1 &&
                (bitboard::between_horizonal(slider_square, king_square) &
-                board.get_occupied_mask<Stm>()) != 0u) {
+                board.template get_occupied_mask<Stm>()) != 0u) {
         int pinned_square = bitboard::get_lsb(
             bitboard::between_horizonal(slider_square, king_square) &
             occupancy_wo_king);
@@ -155,48 +223,95 @@ public:
               bitboard::between_horizonal(king_square, slider_square));
         } else if (pinned == Piece::rook || pinned == Piece::queen) {
           uint64_t moves =
-              (bitboard::between_horizonal(king_square, slider_square) |
-               bitboard::to_bitboard(slider_square)) ^
-              bitboard::to_bitboard(pinned_square);
-          while (moves) {
-            _move_list[_size++] = {pinned_square, bitboard::pop_lsb(moves),
-                                   Piece::none};
-          }
+              ((bitboard::between_horizonal(king_square, slider_square) |
+                bitboard::to_bitboard(slider_square)) ^
+               bitboard::to_bitboard(pinned_square)) &
+              _targets;
+          push_destinations(pinned_square, moves);
         }
       }
       _attacks |= slider_attacks;
     }
 
-    _attacks |= pseudo_king_moves(board.get_king_square<!Stm>());
+    _attacks |= pseudo_king_moves(board.template get_king_square<!Stm>());
 
     // Undo the made moves if the king is in check.
     if (_checkers != 0u) {
-      _size = 0;
+      discard_moves();
+    }
+  }
+
+  // Add a single move, for castling and en passant.
+  void push_move(Move move) {
+    if constexpr (Type == GenType::destinations) {
+      _destinations[move.from()] |= bitboard::to_bitboard(move.to());
+      _size++;
+    } else if constexpr (Type == GenType::count) {
+      _size++;
+    } else {
+      _move_list[_size++] = move;
     }
   }
 
-  void push_pawn_moves(uint64_t mask, int delta) {
+  // Add the moves from one square to every square of mask.
+  void push_destinations(int from, uint64_t mask) {
+    if constexpr (Type == GenType::destinations) {
+      _destinations[from] |= mask;
+      _size += bitboard::pop_count(mask);
+    } else if constexpr (Type == GenType::count) {
+      _size += bitboard::pop_count(mask);
+    } else {
+      _size = serialize_moves(_move_list.data() + _size, from, mask) -
+              _move_list.data();
+    }
+  }
+
+  void discard_moves() {
+    _size = 0;
+    if constexpr (Type == GenType::destinations) {
+      _destinations.fill(0u);
+    }
+  }
+
+  void push_pawn_moves(uint64_t mask, int delta,
+                       MoveType type = MoveType::normal) {
+    if constexpr (Type == GenType::count || Type == GenType::destinations) {
+      // Every promotion is four moves to the same square.
+      const uint64_t promotions = mask & PlayerTraits<Stm>::promotion_mask;
+      _size += bitboard::pop_count(mask) + 3 * bitboard::pop_count(promotions);
+      if constexpr (Type == GenType::destinations) {
+        while (mask) {
+          const int to_square = bitboard::pop_lsb(mask);
+          _destinations[to_square - delta] |= bitboard::to_bitboard(to_square);
+        }
+      }
+      return;
+    }
+
     // Add pawn promotions to the move list.
     uint64_t move_mask = mask & PlayerTraits<Stm>::promotion_mask;
     while (move_mask) {
       int to_square = bitboard::pop_lsb(move_mask);
       int from_square = to_square - delta;
 
-      _move_list[_size++] = {from_square, to_square, Piece::queen};
-      _move_list[_size++] = {from_square, to_square, Piece::knight};
-      _move_list[_size++] = {from_square, to_square, Piece::rook};
-      _move_list[_size++] = {from_square, to_square, Piece::bishop};
+      _move_list[_size++] =
+          Move(from_square, to_square, MoveType::queen_promotion);
+      _move_list[_size++] =
+          Move(from_square, to_square, MoveType::knight_promotion);
+      _move_list[_size++] =
+          Move(from_square, to_square, MoveType::rook_promotion);
+      _move_list[_size++] =
+          Move(from_square, to_square, MoveType::bishop_promotion);
     }
 
     // Add non promotions to the move list.
     move_mask = mask & ~PlayerTraits<Stm>::promotion_mask;
-    while (move_mask) {
-      int square = bitboard::pop_lsb(move_mask);
-      _move_list[_size++] = {square - delta, square, Piece::none};
-    }
+    _size = serialize_pawn_moves(_move_list.data() + _size, delta, move_mask,
+                                 type) -
+            _move_list.data();
   }
 
-  bool is_en_passant_valid(const Board &board, uint64_t valid) {
+  bool is_en_passant_valid(const BoardType &board, uint64_t valid) {
     if (board.en_passant == 0) {
       return false;
     }
@@ -211,9 +326,9 @@ public:
     return (bitboard::to_bitboard(board.en_passant) & valid) != 0u;
   }
 
-  bool en_passant_causes_check(const Board &board, int from) {
+  bool en_passant_causes_check(const BoardType &board, int from) {
     const int captured = board.en_passant - PlayerTraits<Stm>::forward;
-    const int king_square = board.get_king_square<Stm>();
+    const int king_square = board.template get_king_square<Stm>();
     // Update the occupancy as if the move is made.
     uint64_t updated_occupancy =
         board.get_occupied_mask() ^
@@ -221,37 +336,43 @@ public:
     // Generate sliders that check the king using the updated occupancy.
     uint64_t checkers =
         (attacks_from<Piece::bishop>(king_square, updated_occupancy) &
-         board.get_piece_mask<!Stm, Piece::bishop, Piece::queen>()) |
+         board.template get_piece_mask<!Stm, Piece::bishop, Piece::queen>()) |
         (attacks_from<Piece::rook>(king_square, updated_occupancy) &
-         board.get_piece_mask<!Stm, Piece::rook, Piece::queen>());
+         board.template get_piece_mask<!Stm, Piece::rook, Piece::queen>());
     return checkers != 0u;
   }
 
-  void push_en_passant(const Board &board, uint64_t valid) {
-    if (is_en_passant_valid(board, valid)) {
+  void push_en_passant(const BoardType &board, uint64_t valid) {
+    if (Type != GenType::quiets && is_en_passant_valid(board, valid)) {
       uint64_t attackers = pseudo_pawn_attacks(!Stm, board.en_passant) &
-                           board.get_piece_mask<Stm, Piece::pawn>();
+                           board.template get_piece_mask<Stm, Piece::pawn>();
       while (attackers) {
         int from = bitboard::pop_lsb(attackers);
         if (en_passant_causes_check(board, from)) {
           continue;
         }
-        _move_list[_size++] = {from, board.en_passant, Piece::none};
+        push_move(Move(from, board.en_passant, MoveType::en_passant));
       }
     }
   }
 
   void generate_pawn_pushes(uint64_t pawns, uint64_t valid) {
     uint64_t moves = 0u;
+    valid &= push_targets;
     // Single push.
     moves = _gen.pawn_push(pawns) & valid;
     push_pawn_moves(moves, PlayerTraits<Stm>::forward);
     // Double push.
     moves = _gen.pawn_double_push(pawns) & valid;
-    push_pawn_moves(moves, PlayerTraits<Stm>::forward * 2);
+    push_pawn_moves(moves, PlayerTraits<Stm>::forward * 2,
+                    MoveType::double_push);
   }
 
   void generate_pawn_attacks(uint64_t pawns, uint64_t valid) {
+    // Every pawn attack is a capture.
+    if (Type == GenType::quiets) {
+      return;
+    }
     uint64_t moves = 0u;
     // Attacks right.
     moves = _gen.pawn_attacks_right(pawns) & valid;
@@ -261,8 +382,9 @@ public:
     push_pawn_moves(moves, PlayerTraits<Stm>::left);
   }
 
-  void all_pawn_moves(const Board &board, uint64_t valid) {
-    const uint64_t pawns = board.get_piece_mask<Stm, Piece::pawn>() & ~_pinned;
+  void all_pawn_moves(const BoardType &board, uint64_t valid) {
+    const uint64_t pawns =
+        board.template get_piece_mask<Stm, Piece::pawn>() & ~_pinned;
     generate_pawn_attacks(pawns, valid);
     generate_pawn_pushes(pawns, valid);
     push_en_passant(board, valid);
@@ -271,35 +393,34 @@ public:
   template <Piece P> void push_all(uint64_t pieces, uint64_t valid) {
     while (pieces) {
       int from_square = bitboard::pop_lsb(pieces);
-      uint64_t move_mask = _gen.attacks_from<P>(from_square, valid);
-      while (move_mask) {
-        int to_square = bitboard::pop_lsb(move_mask);
-        _move_list[_size++] = {from_square, to_square, Piece::none};
-      }
+      push_destinations(from_square,
+                        _gen.template attacks_from<P>(from_square, valid));
     }
   }
 
-  template <Piece P> uint64_t get_valid_piece_mask(const Board &board, Slider) {
-    return board.get_piece_mask<Stm, P, Piece::queen>() & ~_pinned;
+  template <Piece P>
+  uint64_t get_valid_piece_mask(const BoardType &board, Slider) {
+    return board.template get_piece_mask<Stm, P, Piece::queen>() & ~_pinned;
   }
 
   template <Piece P>
-  uint64_t get_valid_piece_mask(const Board &board, NonSlider) {
-    return board.get_piece_mask<Stm, P>() & ~_pinned;
+  uint64_t get_valid_piece_mask(const BoardType &board, NonSlider) {
+    return board.template get_piece_mask<Stm, P>() & ~_pinned;
   }
 
-  template <Piece P> void push_moves(const Board &board, uint64_t valid) {
-    uint64_t pieces = get_valid_piece_mask<P>(board, PieceTraits<P>::type{});
+  template <Piece P> void push_moves(const BoardType &board, uint64_t valid) {
+    uint64_t pieces =
+        get_valid_piece_mask<P>(board, typename PieceTraits<P>::type{});
     push_all<P>(pieces, valid);
   }
 
-  void generate_castle_moves(const Board &board) {
-    int king_square = board.get_king_square<Stm>();
-    if (board.can_castle_kingside<Stm>(_attacks)) {
-      _move_list[_size++] = {king_square, king_square - 2, Piece::none};
+  void generate_castle_moves(const BoardType &board) {
+    int king_square = board.template get_king_square<Stm>();
+    if (board.template can_castle_kingside<Stm>(_attacks)) {
+      push_move(Move(king_square, king_square - 2, MoveType::castle));
     }
-    if (board.can_castle_queenside<Stm>(_attacks)) {
-      _move_list[_size++] = {king_square, king_square + 2, Piece::none};
+    if (board.template can_castle_queenside<Stm>(_attacks)) {
+      push_move(Move(king_square, king_square + 2, MoveType::castle));
     }
   }
 };
@@ -0,0 +1,161 @@
+#ifndef MOVE_PICKER_H
+#define MOVE_PICKER_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "board.h"
+#include "move.h"
+#include "move_list.h"
+
+// Quiet moves that caused a cutoff in a sibling node, tried after the
+// captures.
+using Killers = std::array<Move, 2>;
+
+// The stages of MovePicker, in the order their moves are returned.
+enum class PickerStage {
+  hash_move,
+  generate_captures,
+  captures,
+  killers,
+  generate_quiets,
+  quiets,
+  done
+};
+
+// Returns the legal moves of a position one stage at a time, so a search
+// that cuts off on an early move skips the work of the later stages. The hash
+// move is checked with Board::is_legal and returned before anything is
+// generated. Captures and promotions follow, most valuable victim first, then
+// the killers, checked the same way, then the remaining quiet moves. Captures
+// and quiets are generated separately, each when its stage is reached. No
+// move is returned twice and null_move marks the end.
+template <Player Stm> class MovePicker {
+private:
+  const Board &_board;
+  Move _hash_move;
+  Killers _killers;
+  PickerStage _stage;
+  std::array<Move, 255> _moves;
+  std::array<int, 255> _scores;
+  // The moves of the current stage are _moves[_current, _end).
+  size_t _current;
+  size_t _end;
+  size_t _killer;
+
+public:
+  MovePicker(const Board &board, Move hash_move = null_move,
+             const Killers &killers = {null_move, null_move})
+      : _board(board), _hash_move(hash_move), _killers(killers),
+        _stage(PickerStage::hash_move), _current(0), _end(0), _killer(0) {}
+
+  PickerStage stage() const { return _stage; }
+
+  Move next() {
+    switch (_stage) {
+    case PickerStage::hash_move:
+      _stage = PickerStage::generate_captures;
+      if (_board.is_legal<Stm>(_hash_move)) {
+        return _hash_move;
+      }
+      [[fallthrough]];
+    case PickerStage::generate_captures:
+      generate_captures();
+      _stage = PickerStage::captures;
+      [[fallthrough]];
+    case PickerStage::captures:
+      while (_current < _end) {
+        Move move = pick_best_capture();
+        if (move != _hash_move) {
+          return move;
+        }
+      }
+      _stage = PickerStage::killers;
+      [[fallthrough]];
+    case PickerStage::killers:
+      while (_killer < _killers.size()) {
+        Move move = _killers[_killer++];
+        if (move != _hash_move && (_killer == 1 || move != _killers[0]) &&
+            !is_tactical(move) && _board.is_legal<Stm>(move)) {
+          return move;
+        }
+      }
+      _stage = PickerStage::generate_quiets;
+      [[fallthrough]];
+    case PickerStage::generate_quiets:
+      generate_quiets();
+      _stage = PickerStage::quiets;
+      [[fallthrough]];
+    case PickerStage::quiets:
+      while (_current < _end) {
+        Move move = _moves[_current++];
+        if (move != _hash_move && move != _killers[0] && move != _killers[1]) {
+          return move;
+        }
+      }
+      _stage = PickerStage::done;
+      [[fallthrough]];
+    case PickerStage::done:
+      break;
+    }
+    return null_move;
+  }
+
+private:
+  // Captures, en passant and promotions.
+  bool is_tactical(Move move) const {
+    return move.is_promotion() || move.type() == MoveType::en_passant ||
+           _board.get_piece(move.to()) != Piece::none;
+  }
+
+  void generate_captures() {
+    MoveList<Stm, GenType::captures> move_list(_board);
+    _current = 0;
+    _end = 0;
+    for (Move move = move_list.get_move(); move != null_move;
+         move = move_list.get_move()) {
+      _scores[_end] = capture_score(move);
+      _moves[_end++] = move;
+    }
+  }
+
+  void generate_quiets() {
+    MoveList<Stm, GenType::quiets> move_list(_board);
+    _current = 0;
+    _end = 0;
+    for (Move move = move_list.get_move(); move != null_move;
+         move = move_list.get_move()) {
+      _moves[_end++] = move;
+    }
+  }
+
+  // Most valuable victim, least valuable attacker. A promotion adds the
+  // value of the new piece and en passant captures a pawn.
+  int capture_score(Move move) const {
+    const Piece moved = _board.get_piece(move.from());
+    const Piece victim = move.type() == MoveType::en_passant
+                             ? Piece::pawn
+                             : _board.get_piece(move.to());
+    return 8 * (static_cast<int>(victim) +
+                static_cast<int>(move.promotion())) -
+           static_cast<int>(moved);
+  }
+
+  // Move the best remaining capture to the front and return it. There are
+  // few captures, so a selection pass beats sorting them up front when the
+  // search cuts off early.
+  Move pick_best_capture() {
+    size_t best = _current;
+    for (size_t i = _current + 1; i < _end; ++i) {
+      if (_scores[i] > _scores[best]) {
+        best = i;
+      }
+    }
+    std::swap(_moves[_current], _moves[best]);
+    std::swap(_scores[_current], _scores[best]);
+    return _moves[_current++];
+  }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef MOVE_SERIALIZE_H
+#define MOVE_SERIALIZE_H
+
+#include <cstdint>
+
+#include "bitboard.h"
+#include "move.h"
+
+// Turn a destination mask into moves. The scalar version pops one square at
+// a time. The SIMD version expands a whole rank of the mask at once: a table
+// gives the set squares of the rank byte, which are widened to 16 bits and
+// combined with the from squares and move type into eight Moves with a
+// single unconditional store. The caller's buffer needs room for 7 moves
+// past the last real one; MoveList holds 255 moves and a position has at
+// most 218.
+//
+// Destination masks rarely have more than two squares on a rank, so on the
+// machines measured so far the scalar loop is at least as fast and the SIMD
+// version is only built when MOVE_SERIALIZE_SIMD is defined along with
+// SSE4.1.
+//
+// Both return the end of the written moves, in the same order as popping
+// the least significant bit first.
+#if defined(MOVE_SERIALIZE_SIMD) && defined(__SSE4_1__)
+#include <smmintrin.h>
+#define MOVE_SERIALIZE_SSE41 1
+#else
+#define MOVE_SERIALIZE_SSE41 0
+#endif
+
+#if MOVE_SERIALIZE_SSE41
+static_assert(sizeof(Move) == sizeof(uint16_t), "Move must be 16 bits");
+
+struct RankSquares {
+  uint8_t squares[256][8];
+};
+
+// The set bits of every byte value, lowest first.
+constexpr RankSquares create_rank_squares() {
+  RankSquares table{};
+  for (int bits = 0; bits < 256; ++bits) {
+    int count = 0;
+    for (int square = 0; square < 8; ++square) {
+      if (bits & (1 << square)) {
+        table.squares[bits][count++] = static_cast<uint8_t>(square);
+      }
+    }
+  }
+  return table;
+}
+
+inline constexpr RankSquares rank_squares = create_rank_squares();
+
+// Store eight moves from the 16 bit lanes of from and to. flags holds the
+// move type already shifted into place.
+inline void store_moves(Move *out, __m128i from, __m128i to, __m128i flags) {
+  const __m128i moves =
+      _mm_or_si128(_mm_or_si128(from, _mm_slli_epi16(to, 6)), flags);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), moves);
+}
+
+// Destinations of the lowest occupied rank of mask, which is cleared.
+inline __m128i pop_rank(uint64_t &mask, int &count) {
+  const int offset = bitboard::get_lsb(mask) & ~7;
+  const unsigned bits = static_cast<unsigned>(mask >> offset) & 0xffu;
+  mask &= ~(0xffull << offset);
+  count = bitboard::pop_count(bits);
+  const __m128i squares = _mm_loadl_epi64(
+      reinterpret_cast<const __m128i *>(rank_squares.squares[bits]));
+  return _mm_add_epi16(_mm_cvtepu8_epi16(squares),
+                       _mm_set1_epi16(static_cast<short>(offset)));
+}
+#endif
+
+// Moves from one square to every square of mask.
+inline Move *serialize_moves(Move *out, int from, uint64_t mask) {
+#if MOVE_SERIALIZE_SSE41
+  const __m128i from_squares = _mm_set1_epi16(static_cast<short>(from));
+  while (mask) {
+    int count;
+    const __m128i to = pop_rank(mask, count);
+    store_moves(out, from_squares, to, _mm_setzero_si128());
+    out += count;
+  }
+#else
+  while (mask) {
+    *out++ = Move(from, bitboard::pop_lsb(mask));
+  }
+#endif
+  return out;
+}
+
+// Moves of type to every square of mask from the square delta behind it.
+inline Move *serialize_pawn_moves(Move *out, int delta, uint64_t mask,
+                                  MoveType type = MoveType::normal) {
+#if MOVE_SERIALIZE_SSE41
+  const __m128i deltas = _mm_set1_epi16(static_cast<short>(delta));
+  const __m128i flags =
+      _mm_set1_epi16(static_cast<short>(static_cast<int>(type) << 12));
+  while (mask) {
+    int count;
+    const __m128i to = pop_rank(mask, count);
+    store_moves(out, _mm_sub_epi16(to, deltas), to, flags);
+    out += count;
+  }
+#else
+  while (mask) {
+    int square = bitboard::pop_lsb(mask);
+    *out++ = Move(square - delta, square, type);
+  }
+#endif
+  return out;
+}
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef PARALLEL_PERFT_H
+#define PARALLEL_PERFT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "fen.h"
+#include "move.h"
+#include "move_list.h"
+#include "perft.h"
+#include "perft_hash.h"
+
+// Nodes this many plies or fewer below the root are split into one task per
+// child. Everything below is counted by a single worker with perft_hashed, so
+// every node with two or more plies left is probed and stored and
+// transpositions deep in the tree are counted once.
+static constexpr int parallel_split_plies = 2;
+
+struct PerftTask {
+  Board board;
+  int depth;
+  int ply;
+};
+
+// A worker's task deque. The owner pushes and pops from the back, thieves
+// take the oldest (and so usually largest) task from the front. Each deque
+// has its own cache line, so locking one does not contend with its
+// neighbours.
+class alignas(64) TaskDeque {
+private:
+  std::deque<PerftTask> _tasks;
+  std::mutex _mutex;
+
+public:
+  void push(PerftTask &&task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(std::move(task));
+  }
+
+  bool pop(PerftTask &task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tasks.empty()) {
+      return false;
+    }
+    task = std::move(_tasks.back());
+    _tasks.pop_back();
+    return true;
+  }
+
+  bool steal(PerftTask &task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tasks.empty()) {
+      return false;
+    }
+    task = std::move(_tasks.front());
+    _tasks.pop_front();
+    return true;
+  }
+};
+
+// Counted in a local by each worker and published once when it finishes.
+struct alignas(64) WorkerStats {
+  uint64_t nodes = 0ull;
+  uint64_t tasks = 0ull;
+  uint64_t steals = 0ull;
+  long long steal_nanoseconds = 0;
+  PerftHashStats hash;
+};
+
+struct ParallelPerftResult {
+  uint64_t nodes = 0ull;
+  long long milliseconds = 0;
+  std::vector<WorkerStats> workers;
+  PerftHashStats hash;
+};
+
+class ParallelPerft {
+private:
+  std::vector<TaskDeque> _deques;
+  std::vector<WorkerStats> _stats;
+  std::atomic<int64_t> _outstanding;
+  PerftHash *_table;
+
+  template <Player Stm>
+  void expand(size_t id, const Board &board, int depth, int ply) {
+    MoveList<Stm> move_list(board);
+    for (Move move = move_list.get_move(); move != null_move;
+         move = move_list.get_move()) {
+      PerftTask child{board, depth - 1, ply + 1};
+      child.board.unmake_stack.clear();
+      child.board.make_move<Stm>(move);
+      _outstanding.fetch_add(1, std::memory_order_relaxed);
+      _deques[id].push(std::move(child));
+    }
+  }
+
+  // Run a single task on the worker's own board. Tasks near the root are
+  // expanded onto the worker's deque, the rest are counted in place.
+  void run(size_t id, Board &board, int depth, int ply, WorkerStats &stats) {
+    stats.tasks++;
+    if (ply < parallel_split_plies && depth > 1) {
+      board.player == Player::white
+          ? expand<Player::white>(id, board, depth, ply)
+          : expand<Player::black>(id, board, depth, ply);
+    } else if (_table != nullptr) {
+      // The probes and stores of a task are counted on the stack and merged
+      // once it is done.
+      PerftHashStats hash;
+      stats.nodes +=
+          board.player == Player::white
+              ? perft_hashed<Player::white>(board, depth, *_table, hash)
+              : perft_hashed<Player::black>(board, depth, *_table, hash);
+      stats.hash += hash;
+    } else {
+      stats.nodes += board.player == Player::white
+                         ? perft<Player::white>(board, depth)
+                         : perft<Player::black>(board, depth);
+    }
+    _outstanding.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  bool try_steal(size_t id, PerftTask &task, WorkerStats &stats) {
+    for (size_t i = 1; i < _deques.size(); ++i) {
+      size_t victim = (id + i) % _deques.size();
+      if (_deques[victim].steal(task)) {
+        stats.steals++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(size_t id) {
+    // Each worker owns its board and unmake stack, tasks are copied in.
+    Board board;
+    PerftTask task;
+    WorkerStats stats;
+    while (true) {
+      if (_deques[id].pop(task)) {
+        board = task.board;
+        run(id, board, task.depth, task.ply, stats);
+        continue;
+      }
+
+      auto then = std::chrono::steady_clock::now();
+      bool found = false;
+      while (_outstanding.load(std::memory_order_acquire) > 0) {
+        if (try_steal(id, task, stats)) {
+          found = true;
+          break;
+        }
+        std::this_thread::yield();
+      }
+      stats.steal_nanoseconds +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - then)
+              .count();
+
+      if (!found) {
+        _stats[id] = stats;
+        return;
+      }
+      board = task.board;
+      run(id, board, task.depth, task.ply, stats);
+    }
+  }
+
+public:
+  // Subtrees are looked up in and stored to the table when one is given.
+  explicit ParallelPerft(unsigned threads, PerftHash *table = nullptr)
+      : _deques(std::max(threads, 1u)), _stats(std::max(threads, 1u)),
+        _outstanding(0), _table(table) {}
+
+  ParallelPerftResult operator()(const Board &board, int depth) {
+    std::fill(_stats.begin(), _stats.end(), WorkerStats{});
+    Clock clock;
+
+    PerftTask root{board, depth, 0};
+    root.board.unmake_stack.clear();
+    _outstanding.store(1);
+    _deques[0].push(std::move(root));
+
+    std::vector<std::thread> threads;
+    for (size_t id = 1; id < _deques.size(); ++id) {
+      threads.emplace_back(&ParallelPerft::work, this, id);
+    }
+    work(0);
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    ParallelPerftResult result;
+    result.milliseconds = clock.elapsed();
+    result.workers = _stats;
+    for (const auto &stats : _stats) {
+      result.nodes += stats.nodes;
+      result.hash += stats.hash;
+    }
+    return result;
+  }
+};
+
+inline unsigned default_thread_count() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+inline void print_parallel_result(const ParallelPerftResult &result) {
+  std::cout << "nodes: " << result.nodes << " time: " << result.milliseconds
+            << "ms";
+  if (result.milliseconds > 0) {
+    std::cout << " speed: " << std::fixed << std::setprecision(2)
+              << result.nodes / (result.milliseconds / 1000.0) / 1000000
+              << "M n/s";
+  }
+  std::cout << '\n';
+
+  for (size_t id = 0; id < result.workers.size(); ++id) {
+    const WorkerStats &stats = result.workers[id];
+    double share =
+        result.nodes == 0
+            ? 0.0
+            : 100.0 * stats.nodes / static_cast<double>(result.nodes);
+    double stealing =
+        result.milliseconds == 0
+            ? 0.0
+            : 100.0 * (stats.steal_nanoseconds / 1000000.0) /
+                  static_cast<double>(result.milliseconds);
+    std::cout << "  thread " << std::setw(3) << id
+              << " nodes: " << std::setw(14) << stats.nodes << " (" << std::setprecision(1) << share
+              << "%) tasks: " << stats.tasks << " steals: " << stats.steals
+              << " stealing: " << stats.steal_nanoseconds / 1000000 << "ms ("
+              << stealing << "%)\n";
+  }
+}
+
+inline void parallel_speed(unsigned threads, size_t hash_megabytes = 0) {
+  std::vector<PerftTest> tests = generate_tests(speed_fen);
+  std::unique_ptr<PerftHash> table;
+  if (hash_megabytes > 0) {
+    table = std::make_unique<PerftHash>(hash_megabytes);
+  }
+  ParallelPerft parallel_perft(threads, table.get());
+
+  std::cout << "Beginning parallel speed test with " << threads
+            << " threads...\n";
+
+  for (auto &test : tests) {
+    Board board = fen::create_board(test.get_fen());
+    std::cout << board << '\n';
+    ParallelPerftResult result = parallel_perft(board, test.get_depth());
+    print_parallel_result(result);
+    if (table) {
+      print_hash_stats(*table, result.hash);
+    }
+    if (result.nodes != test.get_nodes_expected()) {
+      std::cout << "... test failed " << test.get_fen() << " expected: "
+                << test.get_nodes_expected() << '\n';
+    }
+  }
+}
+
+// The depth 9 suite is only practical with a hash table shared between the
+// workers.
+inline void perft_extensive(unsigned threads, size_t hash_megabytes) {
+  std::vector<PerftTest> tests = generate_tests(perft_extensive_vec);
+  PerftHash table(hash_megabytes);
+  ParallelPerft parallel_perft(threads, &table);
+
+  for (auto &test : tests) {
+    Board board = fen::create_board(test.get_fen());
+    ParallelPerftResult result = parallel_perft(board, test.get_depth());
+    test.set_nodes(result.nodes);
+    test.set_milliseconds(result.milliseconds);
+    std::cout << (test.passed() ? "passed: " : "failed: ") << test.get_fen()
+              << " expected: " << test.get_nodes_expected()
+              << " actual: " << test.get_nodes() << '\n';
+    print_parallel_result(result);
+    print_hash_stats(table, result.hash);
+  }
+}
+
+#endif
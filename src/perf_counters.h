@@ -0,0 +1,186 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+// Hardware performance counters around scoped regions, read through Linux
+// perf_event_open. Define PERF_COUNTERS to enable them; otherwise PerfScope
+// is an empty object and nothing is measured or printed.
+#if defined(PERF_COUNTERS) && defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_ENABLED 1
+#else
+#define PERF_COUNTERS_ENABLED 0
+#endif
+
+enum class PerfRegion { perft, move_list, make_unmake, count };
+
+struct PerfCounts {
+  uint64_t cycles = 0ull;
+  uint64_t instructions = 0ull;
+  uint64_t branch_misses = 0ull;
+  uint64_t cache_misses = 0ull;
+
+  PerfCounts &operator+=(const PerfCounts &other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    branch_misses += other.branch_misses;
+    cache_misses += other.cache_misses;
+    return *this;
+  }
+};
+
+#if PERF_COUNTERS_ENABLED
+
+// The four events are opened as one group on the calling thread so they are
+// always scheduled, and read, together.
+class PerfCounters {
+private:
+  static constexpr int events = 4;
+  std::array<int, events> _fds;
+
+  static int open_event(uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+  }
+
+public:
+  PerfCounters() {
+    _fds.fill(-1);
+    const std::array<uint64_t, events> configs = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < events; ++i) {
+      _fds[i] = open_event(configs[i], _fds[0]);
+      if (_fds[i] == -1) {
+        close();
+        return;
+      }
+    }
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+  ~PerfCounters() { close(); }
+
+  void close() {
+    for (int &fd : _fds) {
+      if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  bool is_open() const { return _fds[0] != -1; }
+
+  void start() {
+    if (is_open()) {
+      ioctl(_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  PerfCounts stop() {
+    PerfCounts counts;
+    if (!is_open()) {
+      return counts;
+    }
+    ioctl(_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // PERF_FORMAT_GROUP reads the number of events followed by each value.
+    uint64_t values[1 + events];
+    if (read(_fds[0], values, sizeof(values)) ==
+        static_cast<ssize_t>(sizeof(values))) {
+      counts.cycles = values[1];
+      counts.instructions = values[2];
+      counts.branch_misses = values[3];
+      counts.cache_misses = values[4];
+    }
+    return counts;
+  }
+};
+
+// Counters and totals are per thread; a report covers the thread it is
+// printed from.
+inline PerfCounters &thread_perf_counters() {
+  thread_local PerfCounters counters;
+  return counters;
+}
+
+inline PerfCounts &perf_region_counts(PerfRegion region) {
+  thread_local std::array<PerfCounts, static_cast<size_t>(PerfRegion::count)>
+      totals;
+  return totals[static_cast<size_t>(region)];
+}
+
+// Regions do not nest: the counters are reset when a scope starts.
+class PerfScope {
+private:
+  PerfRegion _region;
+
+public:
+  explicit PerfScope(PerfRegion region) : _region(region) {
+    thread_perf_counters().start();
+  }
+  PerfScope(const PerfScope &) = delete;
+  PerfScope &operator=(const PerfScope &) = delete;
+  ~PerfScope() { perf_region_counts(_region) += thread_perf_counters().stop(); }
+};
+
+inline void reset_perf_counts(PerfRegion region) {
+  perf_region_counts(region) = PerfCounts{};
+}
+
+// Print the totals of region and their rate per node (or per operation).
+inline void print_perf_counts(PerfRegion region, uint64_t nodes,
+                              const char *unit = "node") {
+  if (!thread_perf_counters().is_open()) {
+    std::cout << "perf counters unavailable, the host has no PMU or "
+                 "perf_event_paranoid forbids them"
+              << std::endl;
+    return;
+  }
+  const PerfCounts &counts = perf_region_counts(region);
+  double per = nodes == 0 ? 0.0 : 1.0 / nodes;
+  std::cout << std::fixed << std::setprecision(2) << "cycles: " << counts.cycles
+            << " (" << counts.cycles * per << '/' << unit
+            << ") instructions: " << counts.instructions << " ("
+            << counts.instructions * per << '/' << unit << ", IPC "
+            << (counts.cycles == 0
+                    ? 0.0
+                    : counts.instructions / static_cast<double>(counts.cycles))
+            << ") branch misses: " << counts.branch_misses << " ("
+            << counts.branch_misses * per << '/' << unit
+            << ") cache misses: " << counts.cache_misses << " ("
+            << counts.cache_misses * per << '/' << unit << ')' << std::endl;
+}
+
+#else
+
+class PerfScope {
+public:
+  explicit PerfScope(PerfRegion) {}
+};
+
+inline void reset_perf_counts(PerfRegion) {}
+inline void print_perf_counts(PerfRegion, uint64_t, const char * = "node") {}
+
+#endif
+
+#endif
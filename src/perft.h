@@ -2,7 +2,9 @@
 #define PERFT_H
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
@@ -11,9 +13,13 @@
 #include <vector>
 
 #include "board.h"
+#include "epd.h"
 #include "fen.h"
 #include "move.h"
 #include "move_list.h"
+#include "perf_counters.h"
+#include "perft_test.h"
+#include "position.h"
 
 static constexpr int required_perft_string_size = 8;
 
@@ -83,177 +89,135 @@ static std::vector<std::string> perft_extensive_vec = {
     "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1 9 "
     "7380003266234"};
 
-class Clock {
-private:
-  std::chrono::time_point<std::chrono::steady_clock> _then;
+#include "move_generator.h"
 
-public:
-  Clock() noexcept : _then(std::chrono::steady_clock::now()) {}
-  long long elapsed() const noexcept {
-    auto now = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(now - _then)
-        .count();
+// Leaf move counts by category, as published in the standard perft tables.
+struct PerftStats {
+  uint64_t nodes = 0ull;
+  uint64_t captures = 0ull;
+  uint64_t en_passants = 0ull;
+  uint64_t castles = 0ull;
+  uint64_t promotions = 0ull;
+  uint64_t checks = 0ull;
+  uint64_t discovery_checks = 0ull;
+  uint64_t double_checks = 0ull;
+  uint64_t checkmates = 0ull;
+
+  PerftStats &operator+=(const PerftStats &other) {
+    nodes += other.nodes;
+    captures += other.captures;
+    en_passants += other.en_passants;
+    castles += other.castles;
+    promotions += other.promotions;
+    checks += other.checks;
+    discovery_checks += other.discovery_checks;
+    double_checks += other.double_checks;
+    checkmates += other.checkmates;
+    return *this;
   }
 };
 
-class PerftTest {
-private:
-  std::string _fen;
-  uint64_t _nodes_expected;
-  uint64_t _nodes;
-  int _depth;
-  long long _milliseconds;
-
-public:
-  PerftTest()
-      : _nodes_expected(0ull), _nodes(0ull), _depth(0), _milliseconds(0) {}
-
-  PerftTest(const std::string &fen, int depth, uint64_t nodes_expected)
-      : PerftTest() {
-    _fen = fen;
-    _depth = depth;
-    _nodes_expected = nodes_expected;
-  }
-
-  const std::string &get_fen() const { return _fen; }
-
-  int get_depth() const { return _depth; }
-
-  uint64_t get_nodes() const { return _nodes; }
-
-  uint64_t get_nodes_expected() const { return _nodes_expected; }
+// Counting policies for perft. NodeCount only bulk counts the leaves, while
+// StatsCount also classifies every leaf move into the counters it points to.
+struct NodeCount {
+  static constexpr bool collects_stats = false;
+};
 
-  long long get_milliseconds() const { return _milliseconds; }
+struct StatsCount {
+  static constexpr bool collects_stats = true;
+  PerftStats *stats;
+};
 
-  void set_nodes(uint64_t nodes) { _nodes = nodes; }
+template <Player Stm>
+inline void count_leaf_stats(Board &board, MoveList<Stm> &move_list,
+                             PerftStats &stats) {
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    bool en_passant = move.type() == MoveType::en_passant;
+    bool castle = move.type() == MoveType::castle;
+
+    stats.nodes++;
+    if (en_passant || board.get_piece(move.to()) != Piece::none) {
+      stats.captures++;
+    }
+    if (en_passant) {
+      stats.en_passants++;
+    }
+    if (castle) {
+      stats.castles++;
+    }
+    if (move.is_promotion()) {
+      stats.promotions++;
+    }
 
-  void set_milliseconds(long long milliseconds) {
-    _milliseconds = milliseconds;
+    board.make_move<Stm>(move);
+    uint64_t checkers = board.get_attackers<Stm>(board.get_king_square<!Stm>(),
+                                                 board.get_occupied_mask());
+    if (checkers) {
+      stats.checks++;
+      // When castling gives check the rook is the piece that moved. Double
+      // checks are counted apart from discovery checks, as the tables do.
+      int moved_to = castle ? (move.from() + move.to()) / 2 : move.to();
+      if (checkers & (checkers - 1)) {
+        stats.double_checks++;
+      } else if (checkers & ~bitboard::to_bitboard(moved_to)) {
+        stats.discovery_checks++;
+      }
+      MoveList<!Stm, GenType::count> replies(board);
+      if (replies.size() == 0) {
+        stats.checkmates++;
+      }
+    }
+    board.unmake_move<Stm>(move);
   }
+}
 
-  bool passed() const { return _nodes_expected == _nodes; }
-};
-
-// int ep = 0;
-// int captures = 0;
-// int castles = 0;
-// int promotions = 0;
-// int checks = 0;
-// int checkmates = 0;
-// int double_checks = 0;
-
-#include "move_generator.h"
+// The number of leaves two plies below board. Each move is played on a
+// Position and its replies counted there, so the frontier never makes or
+// unmakes a move on the Board and no Zobrist key is updated.
+template <Player Stm> inline uint64_t perft_frontier(const Board &board) {
+  const Position root(board);
+  MoveList<Stm, GenType::legal, Position> move_list(root);
+  uint64_t nodes = 0ull;
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    Position child = root;
+    child.make_move<Stm>(move);
+    nodes += MoveList<!Stm, GenType::count, Position>(child).size();
+  }
+  return nodes;
+}
 
-template <Player Stm> inline uint64_t perft(Board &board, int depth) {
+template <Player Stm, class Policy = NodeCount>
+inline uint64_t perft(Board &board, int depth, Policy policy = Policy{}) {
   if (depth == 0) {
     return 1ull;
   }
 
-  MoveList<Stm> move_list(board);
   // Bulk counting.
   if (depth == 1) {
-    int ret = move_list.size();
-    /* Move move = move_list.get_move();
-     for (; move != null_move; move = move_list.get_move()) {
-       bool in_check = false;
-       uint64_t occ =
-           board.get_occupied_mask() ^ bitboard::to_bitboard(move.from);
-       switch (board.get_piece(move.from)) {
-       case Piece::pawn:
-         if (board.en_passant != 0 && board.en_passant == move.to) {
-           ep++;
-           captures++;
-           occ ^= bitboard::to_bitboard(board.en_passant +
-                                        PlayerTraits<Stm>::forward);
-         }
-         if (pawn_attacks(Stm, move.to) &
-             board.get_piece_mask<!Stm, Piece::king>()) {
-           checks++;
-           in_check = true;
-         }
-         break;
-       case Piece::knight:
-         if (attacks_from<Piece::knight>(move.to, occ) &
-             board.get_piece_mask<!Stm, Piece::king>()) {
-           checks++;
-           in_check = true;
-         }
-         break;
-       case Piece::bishop:
-         if (attacks_from<Piece::bishop>(move.to, occ) &
-             board.get_piece_mask<!Stm, Piece::king>()) {
-           checks++;
-           in_check = true;
-         }
-         break;
-       case Piece::rook:
-         if (attacks_from<Piece::rook>(move.to, occ) &
-             board.get_piece_mask<!Stm, Piece::king>()) {
-           checks++;
-         }
-         break;
-       case Piece::queen:
-         if (attacks_from<Piece::queen>(move.to, occ) &
-             board.get_piece_mask<!Stm, Piece::king>()) {
-           checks++;
-           in_check = true;
-         }
-         break;
-       case Piece::king:
-         if (abs(move.from - move.to) == 2) {
-           castles++;
-           if (move.to > move.from) {
-             if (attacks_from<Piece::rook>(move.to - 1, occ) &
-                 board.get_piece_mask<!Stm, Piece::king>()) {
-               checks++;
-               in_check = true;
-             }
-           } else {
-             if (attacks_from<Piece::rook>(move.to + 1, occ) &
-                 board.get_piece_mask<!Stm, Piece::king>()) {
-               checks++;
-               in_check = true;
-             }
-           }
-         }
-         break;
-       }
-       int king_square = board.get_king_square<!Stm>();
-       assert(move.to != king_square);
-       if (attacks_from<Piece::bishop>(king_square, occ) &
-           (board.get_piece_mask<Stm, Piece::bishop, Piece::queen>())) {
-         if (in_check) {
-           double_checks++;
-         } else {
-           checks++;
-         }
-       }
-       if (attacks_from<Piece::rook>(king_square, occ) &
-           (board.get_piece_mask<Stm, Piece::rook, Piece::queen>())) {
-         if (in_check) {
-           double_checks++;
-         } else {
-           checks++;
-         }
-       }
-       if (board.get_piece(move.to) != Piece::none) {
-         captures++;
-       }
-     }
-     if (ret == 0) {
-       checkmates++;
-     }*/
-    return ret;
+    if constexpr (Policy::collects_stats) {
+      MoveList<Stm> move_list(board);
+      int ret = move_list.size();
+      count_leaf_stats<Stm>(board, move_list, *policy.stats);
+      return ret;
+    } else {
+      return MoveList<Stm, GenType::count>(board).size();
+    }
   }
+  if constexpr (!Policy::collects_stats) {
+    if (depth == 2) {
+      return perft_frontier<Stm>(board);
+    }
+  }
+
+  MoveList<Stm> move_list(board);
 
   uint64_t nodes = 0ull;
   Move move = move_list.get_move();
-  /*if (move_list.size() == 0) {
-    checkmates++;
-  }*/
   for (; move != null_move; move = move_list.get_move()) {
     board.make_move<Stm>(move);
-    nodes += perft<!Stm>(board, depth - 1);
+    nodes += perft<!Stm>(board, depth - 1, policy);
     board.unmake_move<Stm>(move);
   }
   return nodes;
@@ -263,10 +227,13 @@ template <Player Stm> inline uint64_t perft_speed(Board &board, int depth) {
   if (depth == 0) {
     return 1ull;
   }
-  MoveList<Stm> move_list(board);
   if (depth == 1) {
-    return static_cast<uint64_t>(move_list.size());
+    return MoveList<Stm, GenType::count>(board).size();
   }
+  if (depth == 2) {
+    return perft_frontier<Stm>(board);
+  }
+  MoveList<Stm> move_list(board);
   uint64_t nodes = 0u;
   while (move_list.size() > 0) {
     Move move = move_list.get_move();
@@ -277,11 +244,52 @@ template <Player Stm> inline uint64_t perft_speed(Board &board, int depth) {
   return nodes;
 }
 
+// Copy-make positions are kept one per ply, so a perft never goes deeper than
+// this.
+constexpr int max_copy_make_ply = 64;
+
+using PositionStack = std::array<Position, max_copy_make_ply + 1>;
+
+// Perft by copy-make instead of make/unmake. stack[ply] holds the position;
+// each move is copied into stack[ply + 1] and made there, so nothing is
+// undone and no unmake state is kept.
+template <Player Stm>
+inline uint64_t perft_copy_make(PositionStack &stack, int ply, int depth) {
+  const Position &position = stack[ply];
+  if (depth == 0) {
+    return 1ull;
+  }
+  if (depth == 1) {
+    return MoveList<Stm, GenType::count, Position>(position).size();
+  }
+
+  MoveList<Stm, GenType::legal, Position> move_list(position);
+  Position &child = stack[ply + 1];
+  uint64_t nodes = 0ull;
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    child = position;
+    child.make_move<Stm>(move);
+    nodes += perft_copy_make<!Stm>(stack, ply + 1, depth - 1);
+  }
+  return nodes;
+}
+
+inline uint64_t perft_copy_make(const Board &board, int depth) {
+  ASSERT(depth <= max_copy_make_ply, depth, "Copy-make perft is too deep.");
+  PositionStack stack;
+  stack[0] = Position(board);
+  return board.player == Player::white
+             ? perft_copy_make<Player::white>(stack, 0, depth)
+             : perft_copy_make<Player::black>(stack, 0, depth);
+}
+
 inline void speed_test(std::vector<PerftTest> &tests) {
   uint64_t total_nodes = 0u;
   long long total_milliseconds = 0;
 
   std::cout << "Beginning speed test...\n";
+  reset_perf_counts(PerfRegion::perft);
 
   for (auto &test : tests) {
     Board board = fen::create_board(test.get_fen());
@@ -291,9 +299,13 @@ inline void speed_test(std::vector<PerftTest> &tests) {
                 << std::left << std::setw(4) << depth;
 
       Clock clock;
-      uint64_t nodes = board.player == Player::white
-                           ? perft<Player::white>(board, depth)
-                           : perft<Player::black>(board, depth);
+      uint64_t nodes;
+      {
+        PerfScope scope(PerfRegion::perft);
+        nodes = board.player == Player::white
+                    ? perft<Player::white>(board, depth)
+                    : perft<Player::black>(board, depth);
+      }
       long long milliseconds = clock.elapsed();
       if (milliseconds == 0) {
         std::cout << "N/A" << '\n';
@@ -318,43 +330,49 @@ inline void speed_test(std::vector<PerftTest> &tests) {
               << total_nodes / (total_milliseconds / 1000.0) / 1000000
               << "M n/s\n";
   }
+  print_perf_counts(PerfRegion::perft, total_nodes);
+}
+
+// Record the node count and time of a single perft test.
+inline void measure_test(PerftTest &perft_test) {
+  Board board = fen::create_board(perft_test.get_fen());
+  int depth = perft_test.get_depth();
+
+  Clock clock;
+  PerfScope scope(PerfRegion::perft);
+  uint64_t nodes = board.player == Player::white
+                       ? perft<Player::white>(board, depth)
+                       : perft<Player::black>(board, depth);
+  perft_test.set_milliseconds(clock.elapsed());
+  perft_test.set_nodes(nodes);
+}
+
+inline bool run_test(PerftTest &perft_test) {
+  measure_test(perft_test);
+  if (!perft_test.passed()) {
+    std::cout << "failed: " << perft_test.get_fen()
+              << " expected: " << perft_test.get_nodes_expected()
+              << " actual: " << perft_test.get_nodes() << std::endl;
+  }
+  return perft_test.passed();
+}
+
+inline void print_nps(uint64_t nodes, uint64_t milliseconds) {
+  if (milliseconds > 0) {
+    std::cout << "nps: " << std::fixed << std::setprecision(2)
+              << nodes / (milliseconds / 1000.0) << std::endl;
+  }
 }
 
 inline void run_tests(std::vector<PerftTest> &perft_tests) {
   int failed = 0;
   int passed = 0;
+  reset_perf_counts(PerfRegion::perft);
   for (auto &perft_test : perft_tests) {
-    Board board = fen::create_board(perft_test.get_fen());
-    int depth = perft_test.get_depth();
-
-    // ep = 0;
-    // captures = 0;
-    // castles = 0;
-    // promotions = 0;
-    // checks = 0;
-    // checkmates = 0;
-    // double_checks = 0;
-    Clock clock;
-    uint64_t nodes = board.player == Player::white
-                         ? perft<Player::white>(board, depth)
-                         : perft<Player::black>(board, depth);
-    perft_test.set_milliseconds(clock.elapsed());
-    // std::cout << "ep: " << ep << '\n'
-    //          << "captures: " << captures << '\n'
-    //          << "promotions: " << promotions << '\n'
-    //          << "checks: " << checks << '\n'
-    //          << "double_checks: " << double_checks << '\n'
-    //          << "checkmates: " << checkmates << '\n';
-
-    perft_test.set_nodes(nodes);
-
-    if (!perft_test.passed()) {
-      std::cout << "failed: " << perft_test.get_fen()
-                << " expected: " << perft_test.get_nodes_expected()
-                << " actual: " << perft_test.get_nodes() << std::endl;
-      failed++;
-    } else {
+    if (run_test(perft_test)) {
       passed++;
+    } else {
+      failed++;
     }
     std::cout << "...passed " << passed << " ... failed " << failed
               << std::endl;
@@ -364,18 +382,53 @@ inline void run_tests(std::vector<PerftTest> &perft_tests) {
 
   uint64_t nodes = 0;
   uint64_t milliseconds = 0;
+  uint64_t measured_nodes = 0;
 
   for (const PerftTest &test : perft_tests) {
     if (test.passed()) {
       nodes += test.get_nodes();
       milliseconds += test.get_milliseconds();
     }
+    measured_nodes += test.get_nodes();
   }
 
-  if (milliseconds > 0) {
-    std::cout << "nps: " << std::fixed << std::setprecision(2)
-              << nodes / (milliseconds / 1000.0) << std::endl;
+  print_nps(nodes, milliseconds);
+  print_perf_counts(PerfRegion::perft, measured_nodes);
+}
+
+// Stream a perft suite from an EPD file, running each entry as it is parsed
+// so the suite is never held in memory.
+inline void perft_file(const std::string &path, int max_depth = 0) {
+  epd::Reader reader(path, max_depth);
+  if (!reader.is_open()) {
+    std::cout << "Could not open perft file " << path << '.' << std::endl;
+    return;
+  }
+
+  int failed = 0;
+  int passed = 0;
+  uint64_t nodes = 0;
+  uint64_t milliseconds = 0;
+  uint64_t measured_nodes = 0;
+  reset_perf_counts(PerfRegion::perft);
+  PerftTest perft_test;
+  while (reader.next(perft_test)) {
+    bool test_passed = run_test(perft_test);
+    measured_nodes += perft_test.get_nodes();
+    if (test_passed) {
+      passed++;
+      nodes += perft_test.get_nodes();
+      milliseconds += perft_test.get_milliseconds();
+    } else {
+      failed++;
+    }
+    std::cout << "...passed " << passed << " ... failed " << failed
+              << std::endl;
   }
+
+  std::cout << "...finished!" << std::endl;
+  print_nps(nodes, milliseconds);
+  print_perf_counts(PerfRegion::perft, measured_nodes);
 }
 
 inline std::vector<PerftTest>
@@ -418,7 +471,10 @@ generate_tests(std::vector<std::string> perft_test_vec) {
     }
     uint64_t nodes_expected = std::stoull(nodes_string.c_str());
 
-    perft_tests.push_back(PerftTest(oss.str(), depth, nodes_expected));
+    // Drop the separator written after the last fen field.
+    std::string fen = oss.str();
+    fen.pop_back();
+    perft_tests.push_back(PerftTest(fen, depth, nodes_expected));
   }
 
   return perft_tests;
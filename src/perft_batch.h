@@ -0,0 +1,115 @@
+#ifndef PERFT_BATCH_H
+#define PERFT_BATCH_H
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "epd.h"
+#include "perft.h"
+#include "perft_test.h"
+
+// Totals only, so a streamed suite is not kept in memory once it has run.
+struct BatchResult {
+  size_t positions = 0;
+  uint64_t nodes = 0ull;
+  long long milliseconds = 0;
+  int failed = 0;
+};
+
+// Run independent positions on a pool of workers. Tests are pulled from
+// next(PerftTest &) into a bounded queue, so a streamed suite never has more
+// than queue_capacity positions waiting, and results are collected in the
+// order they finish. Finished tests are added to the totals and dropped.
+template <class Source>
+inline BatchResult run_batch(Source next, unsigned threads,
+                             size_t queue_capacity = 64) {
+  BoundedQueue<PerftTest> queue(queue_capacity);
+  BatchResult result;
+  std::mutex result_mutex;
+
+  auto work = [&]() {
+    PerftTest test;
+    while (queue.pop(test)) {
+      measure_test(test);
+      std::lock_guard<std::mutex> lock(result_mutex);
+      if (!test.passed()) {
+        result.failed++;
+      }
+      std::cout << (test.passed() ? "passed " : "failed ") << std::setw(8)
+                << test.get_milliseconds() << "ms " << test.get_fen()
+                << " depth " << test.get_depth()
+                << " nodes: " << test.get_nodes();
+      if (!test.passed()) {
+        std::cout << " expected: " << test.get_nodes_expected();
+      }
+      std::cout << std::endl;
+      result.positions++;
+      result.nodes += test.get_nodes();
+    }
+  };
+
+  Clock clock;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < std::max(threads, 1u); ++i) {
+    workers.emplace_back(work);
+  }
+
+  PerftTest test;
+  while (next(test)) {
+    queue.push(test);
+  }
+  queue.close();
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  result.milliseconds = clock.elapsed();
+  return result;
+}
+
+inline void print_batch_result(const BatchResult &result) {
+  std::cout << "...finished " << result.positions << " positions, "
+            << result.failed << " failed, in " << result.milliseconds << "ms"
+            << std::endl;
+  if (result.milliseconds > 0) {
+    double seconds = result.milliseconds / 1000.0;
+    std::cout << "positions/s: " << std::fixed << std::setprecision(2)
+              << result.positions / seconds
+              << " nps: " << result.nodes / seconds << std::endl;
+  }
+}
+
+inline void perft_batch(unsigned threads) {
+  std::vector<PerftTest> perft_tests = generate_tests(perft_fast_vec);
+  size_t index = 0;
+  BatchResult result = run_batch(
+      [&](PerftTest &test) {
+        if (index == perft_tests.size()) {
+          return false;
+        }
+        test = perft_tests[index++];
+        return true;
+      },
+      threads);
+  print_batch_result(result);
+}
+
+inline void perft_batch_file(const std::string &path, unsigned threads,
+                             int max_depth = 0) {
+  epd::Reader reader(path, max_depth);
+  if (!reader.is_open()) {
+    std::cout << "Could not open perft file " << path << '.' << std::endl;
+    return;
+  }
+  BatchResult result = run_batch(
+      [&](PerftTest &test) { return reader.next(test); }, threads);
+  print_batch_result(result);
+}
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef PERFT_BENCH_H
+#define PERFT_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+#include "fen.h"
+#include "perft.h"
+#include "perft_test.h"
+#include "slider_attacks.h"
+
+// Exit codes of the bench command.
+constexpr int bench_passed = 0;
+constexpr int bench_regressed = 1;
+constexpr int bench_failed = 2;
+
+struct BenchPosition {
+  std::string fen;
+  int depth;
+  uint64_t nodes;
+  long long nanoseconds;
+};
+
+struct BenchReport {
+  std::vector<BenchPosition> positions;
+  uint64_t nodes = 0ull;
+  long long nanoseconds = 0;
+  bool correct = true;
+};
+
+inline double nodes_per_second(uint64_t nodes, long long nanoseconds) {
+  return nanoseconds == 0 ? 0.0 : nodes * 1e9 / nanoseconds;
+}
+
+inline std::string build_info() {
+  std::ostringstream o;
+#if defined(__clang__)
+  o << "clang " << __clang_major__ << '.' << __clang_minor__;
+#elif defined(__GNUC__)
+  o << "gcc " << __GNUC__ << '.' << __GNUC_MINOR__;
+#elif defined(_MSC_VER)
+  o << "msvc " << _MSC_VER;
+#else
+  o << "unknown compiler";
+#endif
+  o << ", " << sizeof(void *) * 8 << " bit";
+#if defined(NDEBUG)
+  o << ", release";
+#else
+  o << ", debug";
+#endif
+#if defined(__POPCNT__)
+  o << ", popcnt";
+#endif
+#if defined(__BMI2__)
+  o << ", bmi2";
+#endif
+#if defined(__AVX2__)
+  o << ", avx2";
+#endif
+  o << ", built " << __DATE__ << ' ' << __TIME__;
+  return o.str();
+}
+
+// Run every position of the fast perft suite runs times, keeping the fastest
+// time of each so one noisy run does not decide the result. The node counts
+// are checked as well, a fast but wrong generator is not an improvement.
+inline BenchReport run_bench(int runs) {
+  BenchReport report;
+  for (auto &test : generate_tests(perft_fast_vec)) {
+    BenchPosition position{test.get_fen(), test.get_depth(), 0ull, 0};
+    for (int run = 0; run < std::max(runs, 1); ++run) {
+      Board board = fen::create_board(test.get_fen());
+      Clock clock;
+      uint64_t nodes = board.player == Player::white
+                           ? perft<Player::white>(board, test.get_depth())
+                           : perft<Player::black>(board, test.get_depth());
+      long long nanoseconds = clock.elapsed_nanoseconds();
+      if (run == 0 || nanoseconds < position.nanoseconds) {
+        position.nanoseconds = nanoseconds;
+      }
+      position.nodes = nodes;
+    }
+    if (position.nodes != test.get_nodes_expected()) {
+      std::cout << "failed: " << position.fen
+                << " expected: " << test.get_nodes_expected()
+                << " actual: " << position.nodes << std::endl;
+      report.correct = false;
+    }
+    report.nodes += position.nodes;
+    report.nanoseconds += position.nanoseconds;
+    report.positions.push_back(position);
+  }
+  return report;
+}
+
+// The top level fields come before the positions and every position is on
+// its own line, which is what read_bench_baseline relies on.
+inline void write_bench_json(std::ostream &o, const BenchReport &report) {
+  o << std::fixed << std::setprecision(0) << "{\n  \"build\": \""
+    << build_info() << "\",\n  \"sliders\": \"" << to_string(slider_backend)
+    << "\",\n  \"nodes\": " << report.nodes
+    << ",\n  \"elapsed_ns\": " << report.nanoseconds << ",\n  \"nps\": "
+    << nodes_per_second(report.nodes, report.nanoseconds)
+    << ",\n  \"positions\": [";
+  for (size_t i = 0; i < report.positions.size(); ++i) {
+    const BenchPosition &position = report.positions[i];
+    o << (i == 0 ? "\n" : ",\n") << "    {\"fen\": \"" << position.fen
+      << "\", \"depth\": " << position.depth
+      << ", \"nodes\": " << position.nodes
+      << ", \"elapsed_ns\": " << position.nanoseconds << ", \"nps\": "
+      << nodes_per_second(position.nodes, position.nanoseconds) << "}";
+  }
+  o << "\n  ]\n}\n";
+}
+
+struct BenchBaseline {
+  double nps = 0.0;
+  std::unordered_map<std::string, double> position_nps;
+};
+
+inline bool find_json_value(const std::string &text, const std::string &key,
+                            std::string &value) {
+  const std::string quoted = '"' + key + "\": ";
+  size_t start = text.find(quoted);
+  if (start == std::string::npos) {
+    return false;
+  }
+  start += quoted.size();
+  if (text[start] == '"') {
+    size_t end = text.find('"', start + 1);
+    value = text.substr(start + 1, end - start - 1);
+  } else {
+    size_t end = text.find_first_of(",}\n", start);
+    value = text.substr(start, end - start);
+  }
+  return true;
+}
+
+// Read a file written by write_bench_json.
+inline bool read_bench_baseline(const std::string &path,
+                                BenchBaseline &baseline) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  std::string value;
+  bool found_total = false;
+  while (std::getline(file, line)) {
+    std::string fen;
+    if (find_json_value(line, "fen", fen)) {
+      if (find_json_value(line, "nps", value)) {
+        baseline.position_nps[fen] = std::atof(value.c_str());
+      }
+    } else if (!found_total && find_json_value(line, "nps", value)) {
+      baseline.nps = std::atof(value.c_str());
+      found_total = true;
+    }
+  }
+  return found_total;
+}
+
+// Report the change against the baseline for the whole run and each
+// position. Returns false when the total throughput dropped by more than
+// threshold percent.
+inline bool compare_bench(const BenchReport &report,
+                          const BenchBaseline &baseline, double threshold) {
+  auto change = [](double now, double then) {
+    return then == 0.0 ? 0.0 : 100.0 * (now - then) / then;
+  };
+
+  std::cout << std::fixed << std::setprecision(1);
+  for (const auto &position : report.positions) {
+    auto it = baseline.position_nps.find(position.fen);
+    if (it == baseline.position_nps.end()) {
+      continue;
+    }
+    double delta =
+        change(nodes_per_second(position.nodes, position.nanoseconds),
+               it->second);
+    if (delta < -threshold) {
+      std::cout << "slower " << std::setw(7) << delta << "% " << position.fen
+                << '\n';
+    }
+  }
+
+  double now = nodes_per_second(report.nodes, report.nanoseconds);
+  double delta = change(now, baseline.nps);
+  std::cout << "nps: " << std::setprecision(0) << now
+            << " baseline: " << baseline.nps << " change: "
+            << std::setprecision(1) << delta << "% (threshold -" << threshold
+            << "%)" << std::endl;
+  return delta >= -threshold;
+}
+
+// Run the bench workload, optionally writing it to output and gating it
+// against the baseline file. Returns the process exit code.
+inline int perft_bench(const std::string &output, const std::string &baseline,
+                       double threshold, int runs) {
+  BenchReport report = run_bench(runs);
+  std::cout << "nodes: " << report.nodes << " elapsed: "
+            << report.nanoseconds / 1000000 << "ms nps: " << std::fixed
+            << std::setprecision(0)
+            << nodes_per_second(report.nodes, report.nanoseconds)
+            << std::endl;
+
+  if (!output.empty()) {
+    std::ofstream file(output);
+    if (!file) {
+      std::cout << "Could not open " << output << " for writing." << std::endl;
+      return bench_failed;
+    }
+    write_bench_json(file, report);
+  }
+  if (!report.correct) {
+    return bench_failed;
+  }
+  if (baseline.empty()) {
+    return bench_passed;
+  }
+
+  BenchBaseline previous;
+  if (!read_bench_baseline(baseline, previous)) {
+    std::cout << "Could not read baseline " << baseline << '.' << std::endl;
+    return bench_failed;
+  }
+  return compare_bench(report, previous, threshold) ? bench_passed
+                                                    : bench_regressed;
+}
+
+// Run the bench workload with every slider backend the CPU supports and
+// print their speed and table size side by side. The startup choice is
+// restored afterwards.
+inline void compare_slider_backends(int runs) {
+  const SliderBackend selected = slider_backend;
+  double magic_nps = 0.0;
+  for (SliderBackend backend : slider_backends) {
+    if (!set_slider_backend(backend)) {
+      std::cout << to_string(backend) << ": not supported on this CPU"
+                << std::endl;
+      continue;
+    }
+    BenchReport report = run_bench(runs);
+    double nps = nodes_per_second(report.nodes, report.nanoseconds);
+    if (backend == SliderBackend::magic) {
+      magic_nps = nps;
+    }
+    std::cout << std::left << std::setw(12) << to_string(backend)
+              << std::right << " tables: " << std::setw(4)
+              << slider_table_bytes(backend) / 1024
+              << "KB nodes: " << report.nodes << " elapsed: "
+              << report.nanoseconds / 1000000 << "ms nps: " << std::fixed
+              << std::setprecision(0) << nps;
+    if (backend != SliderBackend::magic && magic_nps > 0.0) {
+      std::cout << " (" << std::showpos << std::setprecision(1)
+                << 100.0 * (nps - magic_nps) / magic_nps << std::noshowpos
+                << "% vs magic)";
+    }
+    std::cout << (backend == selected ? " [selected at startup]" : "")
+              << std::endl;
+  }
+  set_slider_backend(selected);
+}
+
+// Time perft by make/unmake against perft by copy-make on every built in
+// suite, fastest of runs for each. Depths are capped at max_depth so the
+// extensive suite finishes; a capped test is checked by the two node counts
+// agreeing, a full depth test against its expected count as well.
+inline bool compare_copy_make(int max_depth, int runs) {
+  const std::vector<std::pair<const char *, const std::vector<std::string> *>>
+      suites = {{"fast", &perft_fast_vec},
+                {"speed", &speed_fen},
+                {"extensive", &perft_extensive_vec}};
+  bool correct = true;
+  for (const auto &suite : suites) {
+    uint64_t nodes = 0ull;
+    long long make_unmake_nanoseconds = 0;
+    long long copy_make_nanoseconds = 0;
+    for (auto &test : generate_tests(*suite.second)) {
+      const int depth = std::min(test.get_depth(), max_depth);
+      const Board start = fen::create_board(test.get_fen());
+      uint64_t make_unmake_nodes = 0ull;
+      uint64_t copy_make_nodes = 0ull;
+      long long make_unmake_best = 0;
+      long long copy_make_best = 0;
+      for (int run = 0; run < std::max(runs, 1); ++run) {
+        Board board = start;
+        Clock clock;
+        make_unmake_nodes = board.player == Player::white
+                                ? perft<Player::white>(board, depth)
+                                : perft<Player::black>(board, depth);
+        long long nanoseconds = clock.elapsed_nanoseconds();
+        if (run == 0 || nanoseconds < make_unmake_best) {
+          make_unmake_best = nanoseconds;
+        }
+
+        clock = Clock();
+        copy_make_nodes = perft_copy_make(start, depth);
+        nanoseconds = clock.elapsed_nanoseconds();
+        if (run == 0 || nanoseconds < copy_make_best) {
+          copy_make_best = nanoseconds;
+        }
+      }
+      if (copy_make_nodes != make_unmake_nodes ||
+          (depth == test.get_depth() &&
+           make_unmake_nodes != test.get_nodes_expected())) {
+        std::cout << "failed: " << test.get_fen() << " depth " << depth
+                  << " make/unmake: " << make_unmake_nodes
+                  << " copy-make: " << copy_make_nodes << std::endl;
+        correct = false;
+      }
+      nodes += make_unmake_nodes;
+      make_unmake_nanoseconds += make_unmake_best;
+      copy_make_nanoseconds += copy_make_best;
+    }
+    const double make_unmake_nps =
+        nodes_per_second(nodes, make_unmake_nanoseconds);
+    const double copy_make_nps = nodes_per_second(nodes, copy_make_nanoseconds);
+    std::cout << std::left << std::setw(10) << suite.first << std::right
+              << " nodes: " << nodes << " make/unmake nps: " << std::fixed
+              << std::setprecision(0) << make_unmake_nps
+              << " copy-make nps: " << copy_make_nps << " (" << std::showpos
+              << std::setprecision(1)
+              << (make_unmake_nps == 0.0
+                      ? 0.0
+                      : 100.0 * (copy_make_nps - make_unmake_nps) /
+                            make_unmake_nps)
+              << std::noshowpos << "%)" << std::endl;
+  }
+  return correct;
+}
+
+#endif
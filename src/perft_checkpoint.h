@@ -0,0 +1,231 @@
+#ifndef PERFT_CHECKPOINT_H
+#define PERFT_CHECKPOINT_H
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "board.h"
+#include "fen.h"
+#include "move.h"
+#include "move_list.h"
+#include "parallel_perft.h"
+#include "perft_hash.h"
+#include "perft_test.h"
+
+// Records finished root and second ply subtree counts of a long perft run so
+// an interrupted run can pick up where it left off. The file is plain text:
+//
+//     clevergirl2-perft-checkpoint 1
+//     <fen>
+//     <depth>
+//     <root move> <reply or -> <nodes> <checksum>
+//
+// Every checksum covers the fen and depth as well as the record, so records
+// from another position or depth are rejected along with corrupted ones.
+class PerftCheckpoint {
+private:
+  static constexpr const char *magic = "clevergirl2-perft-checkpoint 1";
+
+  std::string _path;
+  std::string _fen;
+  int _depth;
+  std::unordered_map<std::string, uint64_t> _counts;
+  std::ofstream _file;
+
+  static std::string key(const std::string &root, const std::string &reply) {
+    return root + ' ' + reply;
+  }
+
+  uint64_t checksum(const std::string &record) const {
+    // 64 bit FNV-1a.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const std::string &s) {
+      for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+      }
+    };
+    mix(_fen);
+    mix(std::to_string(_depth));
+    mix(record);
+    return hash;
+  }
+
+public:
+  PerftCheckpoint(const std::string &path, const std::string &fen, int depth)
+      : _path(path), _fen(fen), _depth(depth) {}
+
+  // Load any records already in the file. Returns false when the file
+  // belongs to another run or a record fails its checksum; a partially
+  // written final line from an interrupted run is dropped.
+  bool load() {
+    std::ifstream in(_path, std::ios::binary);
+    if (!in) {
+      return true;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+    if (contents.empty()) {
+      return true;
+    }
+
+    std::istringstream lines(contents);
+    std::string line;
+    if (!std::getline(lines, line) || line != magic) {
+      std::cout << "Checkpoint " << _path << " is not a perft checkpoint."
+                << std::endl;
+      return false;
+    }
+    std::string fen;
+    std::string depth;
+    if (!std::getline(lines, fen) || !std::getline(lines, depth) ||
+        fen != _fen || depth != std::to_string(_depth)) {
+      std::cout << "Checkpoint " << _path << " is for a different fen or depth."
+                << std::endl;
+      return false;
+    }
+
+    bool complete_last_line = contents.back() == '\n';
+    while (std::getline(lines, line)) {
+      if (lines.eof() && !complete_last_line) {
+        // Cut the partial record off so new records start on a fresh line.
+        in.close();
+        std::filesystem::resize_file(_path, contents.size() - line.size());
+        break;
+      }
+      std::istringstream fields(line);
+      std::string root;
+      std::string reply;
+      uint64_t nodes;
+      uint64_t sum;
+      if (!(fields >> root >> reply >> nodes >> std::hex >> sum) ||
+          sum != checksum(key(root, reply) + ' ' + std::to_string(nodes))) {
+        std::cout << "Checkpoint " << _path << " has a corrupted record: "
+                  << line << std::endl;
+        return false;
+      }
+      _counts[key(root, reply)] = nodes;
+    }
+    return true;
+  }
+
+  bool open() {
+    std::ifstream existing(_path);
+    bool write_header = !existing || existing.peek() == EOF;
+    existing.close();
+
+    _file.open(_path, std::ios::app | std::ios::binary);
+    if (!_file) {
+      std::cout << "Could not open checkpoint " << _path << " for writing."
+                << std::endl;
+      return false;
+    }
+    if (write_header) {
+      _file << magic << '\n' << _fen << '\n' << _depth << '\n';
+      _file.flush();
+    }
+    return true;
+  }
+
+  size_t size() const { return _counts.size(); }
+
+  bool find(const std::string &root, const std::string &reply,
+            uint64_t &nodes) const {
+    auto it = _counts.find(key(root, reply));
+    if (it == _counts.end()) {
+      return false;
+    }
+    nodes = it->second;
+    return true;
+  }
+
+  void record(const std::string &root, const std::string &reply,
+              uint64_t nodes) {
+    std::string record = key(root, reply) + ' ' + std::to_string(nodes);
+    _counts[key(root, reply)] = nodes;
+    _file << record << ' ' << std::hex << checksum(record) << std::dec << '\n';
+    _file.flush();
+  }
+};
+
+template <Player Stm>
+inline uint64_t perft_resumable(Board &board, int depth,
+                                PerftCheckpoint &checkpoint,
+                                ParallelPerft &parallel_perft) {
+  uint64_t nodes = 0ull;
+  MoveList<Stm> root_list(board);
+  for (Move root = root_list.get_move(); root != null_move;
+       root = root_list.get_move()) {
+    const std::string root_name = to_string(root);
+    uint64_t root_nodes = 0ull;
+    if (checkpoint.find(root_name, "-", root_nodes)) {
+      nodes += root_nodes;
+      continue;
+    }
+
+    board.make_move<Stm>(root);
+    MoveList<!Stm> reply_list(board);
+    for (Move reply = reply_list.get_move(); reply != null_move;
+         reply = reply_list.get_move()) {
+      const std::string reply_name = to_string(reply);
+      uint64_t reply_nodes = 0ull;
+      if (!checkpoint.find(root_name, reply_name, reply_nodes)) {
+        board.make_move<!Stm>(reply);
+        reply_nodes = parallel_perft(board, depth - 2).nodes;
+        board.unmake_move<!Stm>(reply);
+        checkpoint.record(root_name, reply_name, reply_nodes);
+      }
+      root_nodes += reply_nodes;
+    }
+    board.unmake_move<Stm>(root);
+
+    checkpoint.record(root_name, "-", root_nodes);
+    std::cout << root_name << ": " << root_nodes << std::endl;
+    nodes += root_nodes;
+  }
+  return nodes;
+}
+
+// Run a perft of at least two plies, checkpointing each finished second ply
+// subtree to path and skipping those already recorded there.
+inline void perft_checkpointed(const std::string &fen, int depth,
+                               const std::string &path, unsigned threads,
+                               size_t hash_megabytes) {
+  if (depth < 2) {
+    std::cout << "Checkpointed perft needs a depth of at least 2." << std::endl;
+    return;
+  }
+
+  PerftCheckpoint checkpoint(path, fen, depth);
+  if (!checkpoint.load() || !checkpoint.open()) {
+    return;
+  }
+  if (checkpoint.size() > 0) {
+    std::cout << "Resuming with " << checkpoint.size()
+              << " finished subtrees from " << path << std::endl;
+  }
+
+  std::unique_ptr<PerftHash> table;
+  if (hash_megabytes > 0) {
+    table = std::make_unique<PerftHash>(hash_megabytes);
+  }
+  ParallelPerft parallel_perft(threads, table.get());
+
+  Board board = fen::create_board(fen);
+  Clock clock;
+  uint64_t nodes =
+      board.player == Player::white
+          ? perft_resumable<Player::white>(board, depth, checkpoint,
+                                           parallel_perft)
+          : perft_resumable<Player::black>(board, depth, checkpoint,
+                                           parallel_perft);
+  std::cout << "\nNodes searched: " << nodes << " in " << clock.elapsed()
+            << "ms" << std::endl;
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef PERFT_DIVIDE_H
+#define PERFT_DIVIDE_H
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "fen.h"
+#include "move.h"
+#include "move_list.h"
+#include "perft.h"
+#include "perft_test.h"
+
+struct DivideEntry {
+  std::string move;
+  uint64_t nodes;
+  long long microseconds;
+};
+
+// Count the subtree below each root move separately.
+template <Player Stm>
+inline std::vector<DivideEntry> divide(Board &board, int depth) {
+  std::vector<DivideEntry> entries;
+  MoveList<Stm> move_list(board);
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    Clock clock;
+    board.make_move<Stm>(move);
+    uint64_t nodes = perft<!Stm>(board, depth - 1);
+    board.unmake_move<Stm>(move);
+    entries.push_back({to_string(move), nodes, clock.elapsed_microseconds()});
+  }
+  // Sort the same way reference engines print their divide output.
+  std::sort(entries.begin(), entries.end(),
+            [](const DivideEntry &a, const DivideEntry &b) {
+              return a.move < b.move;
+            });
+  return entries;
+}
+
+inline double mnps(uint64_t nodes, long long microseconds) {
+  return microseconds == 0 ? 0.0 : nodes / static_cast<double>(microseconds);
+}
+
+inline void write_divide_json(std::ostream &o, const std::string &fen,
+                              int depth,
+                              const std::vector<DivideEntry> &entries,
+                              uint64_t nodes, long long microseconds) {
+  o << "{\n  \"fen\": \"" << fen << "\",\n  \"depth\": " << depth
+    << ",\n  \"nodes\": " << nodes << ",\n  \"microseconds\": "
+    << microseconds << ",\n  \"moves\": [";
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const DivideEntry &entry = entries[i];
+    o << (i == 0 ? "\n" : ",\n") << "    {\"move\": \"" << entry.move
+      << "\", \"nodes\": " << entry.nodes
+      << ", \"microseconds\": " << entry.microseconds
+      << ", \"nps\": " << std::fixed << std::setprecision(0)
+      << mnps(entry.nodes, entry.microseconds) * 1000000 << "}";
+  }
+  o << "\n  ]\n}\n";
+}
+
+// Print each root move's node count, time and speed, followed by the
+// "move: nodes" lines reference engines print. When output is given the
+// same results are written to it as JSON.
+inline void perft_divide(const std::string &fen, int depth,
+                         const std::string &output = "") {
+  if (depth < 1) {
+    std::cout << "Divide depth must be at least 1." << std::endl;
+    return;
+  }
+
+  Board board = fen::create_board(fen);
+  Clock clock;
+  std::vector<DivideEntry> entries =
+      board.player == Player::white ? divide<Player::white>(board, depth)
+                                    : divide<Player::black>(board, depth);
+  long long microseconds = clock.elapsed_microseconds();
+
+  uint64_t nodes = 0ull;
+  for (const auto &entry : entries) {
+    nodes += entry.nodes;
+  }
+
+  std::cout << std::left << std::setw(8) << "move" << std::right
+            << std::setw(16) << "nodes" << std::setw(12) << "ms"
+            << std::setw(12) << "M n/s" << std::setw(10) << "share" << '\n';
+  for (const auto &entry : entries) {
+    std::cout << std::left << std::setw(8) << entry.move << std::right
+              << std::setw(16) << entry.nodes << std::setw(12) << std::fixed
+              << std::setprecision(2) << entry.microseconds / 1000.0
+              << std::setw(12) << mnps(entry.nodes, entry.microseconds)
+              << std::setw(9) << std::setprecision(1)
+              << (nodes == 0 ? 0.0 : 100.0 * entry.nodes / nodes) << "%\n";
+  }
+  std::cout << '\n';
+  for (const auto &entry : entries) {
+    std::cout << entry.move << ": " << entry.nodes << '\n';
+  }
+  std::cout << "\nNodes searched: " << nodes << '\n'
+            << "Time: " << std::setprecision(2) << microseconds / 1000.0
+            << "ms (" << mnps(nodes, microseconds) << "M n/s)" << std::endl;
+
+  if (!output.empty()) {
+    std::ofstream file(output);
+    if (!file) {
+      std::cout << "Could not open " << output << " for writing." << std::endl;
+      return;
+    }
+    write_divide_json(file, fen, depth, entries, nodes, microseconds);
+  }
+}
+
+#endif
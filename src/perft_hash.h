@@ -0,0 +1,159 @@
+#ifndef PERFT_HASH_H
+#define PERFT_HASH_H
+
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "board.h"
+#include "move.h"
+#include "move_list.h"
+#include "perft.h"
+
+struct PerftHashStats {
+  uint64_t probes = 0ull;
+  uint64_t hits = 0ull;
+  uint64_t stores = 0ull;
+  uint64_t replacements = 0ull;
+
+  PerftHashStats &operator+=(const PerftHashStats &other) {
+    probes += other.probes;
+    hits += other.hits;
+    stores += other.stores;
+    replacements += other.replacements;
+    return *this;
+  }
+};
+
+// Lockless perft hash table. Each entry stores the key xor'd with its data
+// word, so a torn write from two threads storing at once fails the key check
+// on the next probe instead of returning a wrong count.
+class PerftHash {
+private:
+  static constexpr int entries_per_bucket = 4;
+  static constexpr uint64_t depth_mask = 0xff;
+  static constexpr int count_shift = 8;
+
+  struct Entry {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+  };
+
+  struct alignas(64) Bucket {
+    Entry entries[entries_per_bucket];
+  };
+
+  std::vector<Bucket> _buckets;
+  uint64_t _mask;
+
+  static int depth_of(uint64_t data) { return static_cast<int>(data & depth_mask); }
+
+public:
+  explicit PerftHash(size_t megabytes) {
+    size_t bucket_count = 1;
+    while (bucket_count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) {
+      bucket_count *= 2;
+    }
+    _buckets = std::vector<Bucket>(bucket_count);
+    _mask = bucket_count - 1;
+    clear();
+  }
+
+  void clear() {
+    for (auto &bucket : _buckets) {
+      for (auto &entry : bucket.entries) {
+        entry.check.store(0ull, std::memory_order_relaxed);
+        entry.data.store(0ull, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t size_in_bytes() const { return _buckets.size() * sizeof(Bucket); }
+
+  bool probe(uint64_t key, int depth, uint64_t &nodes,
+             PerftHashStats &stats) const {
+    stats.probes++;
+    const Bucket &bucket = _buckets[key & _mask];
+    for (const auto &entry : bucket.entries) {
+      uint64_t data = entry.data.load(std::memory_order_relaxed);
+      uint64_t check = entry.check.load(std::memory_order_relaxed);
+      if ((check ^ data) == key && depth_of(data) == depth && data != 0ull) {
+        nodes = data >> count_shift;
+        stats.hits++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Replace the entry for the same key if there is one, otherwise the
+  // shallowest entry in the bucket since it is the cheapest to recount.
+  void store(uint64_t key, int depth, uint64_t nodes, PerftHashStats &stats) {
+    Bucket &bucket = _buckets[key & _mask];
+    Entry *replace = &bucket.entries[0];
+    int replace_depth = depth_mask + 1;
+    for (auto &entry : bucket.entries) {
+      uint64_t data = entry.data.load(std::memory_order_relaxed);
+      uint64_t check = entry.check.load(std::memory_order_relaxed);
+      if (data == 0ull || (check ^ data) == key) {
+        replace = &entry;
+        replace_depth = -1;
+        break;
+      }
+      if (depth_of(data) < replace_depth) {
+        replace = &entry;
+        replace_depth = depth_of(data);
+      }
+    }
+    if (replace_depth >= 0) {
+      stats.replacements++;
+    }
+    stats.stores++;
+
+    uint64_t data = nodes << count_shift | static_cast<uint64_t>(depth);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+  }
+};
+
+template <Player Stm>
+inline uint64_t perft_hashed(Board &board, int depth, PerftHash &table,
+                             PerftHashStats &stats) {
+  // Leaf counts are cheaper to generate than to look up.
+  if (depth <= 1) {
+    return perft<Stm>(board, depth);
+  }
+
+  uint64_t nodes = 0ull;
+  if (table.probe(board.key, depth, nodes, stats)) {
+    return nodes;
+  }
+
+  MoveList<Stm> move_list(board);
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    board.make_move<Stm>(move);
+    nodes += perft_hashed<!Stm>(board, depth - 1, table, stats);
+    board.unmake_move<Stm>(move);
+  }
+
+  table.store(board.key, depth, nodes, stats);
+  return nodes;
+}
+
+inline void print_hash_stats(const PerftHash &table,
+                             const PerftHashStats &stats) {
+  std::cout << "hash: " << table.size_in_bytes() / (1024 * 1024) << "MB"
+            << " probes: " << stats.probes << " hits: " << stats.hits;
+  if (stats.probes > 0) {
+    std::cout << " (" << std::fixed << std::setprecision(1)
+              << 100.0 * stats.hits / static_cast<double>(stats.probes)
+              << "%)";
+  }
+  std::cout << " stores: " << stats.stores
+            << " replacements: " << stats.replacements << '\n';
+}
+
+#endif
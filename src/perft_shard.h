@@ -0,0 +1,289 @@
+#ifndef PERFT_SHARD_H
+#define PERFT_SHARD_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+#include "fen.h"
+#include "move_list.h"
+#include "parallel_perft.h"
+#include "perft_hash.h"
+#include "perft_test.h"
+#include "socket.h"
+
+// A subtree handed to a worker process. Transpositions at the split ply are
+// merged, so one shard stands for every path that reaches its position.
+struct PerftShard {
+  std::string fen;
+  int depth;
+  uint64_t paths;
+  uint64_t nodes;
+  int attempts;
+};
+
+template <Player Stm>
+inline void expand_shards(Board &board, int ply, int depth,
+                          std::unordered_map<std::string, size_t> &index,
+                          std::vector<PerftShard> &shards) {
+  if (ply == 0) {
+    std::string fen = fen::to_fen(board);
+    auto it = index.find(fen);
+    if (it != index.end()) {
+      shards[it->second].paths++;
+    } else {
+      index.emplace(fen, shards.size());
+      shards.push_back({fen, depth, 1ull, 0ull, 0});
+    }
+    return;
+  }
+
+  MoveList<Stm> move_list(board);
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    board.make_move<Stm>(move);
+    expand_shards<!Stm>(board, ply - 1, depth, index, shards);
+    board.unmake_move<Stm>(move);
+  }
+}
+
+// Expand fen split_ply plies deep into shards of depth - split_ply.
+inline std::vector<PerftShard> create_shards(const std::string &fen, int depth,
+                                             int split_ply) {
+  split_ply = std::max(std::min(split_ply, depth - 1), 0);
+  Board board = fen::create_board(fen);
+  std::unordered_map<std::string, size_t> index;
+  std::vector<PerftShard> shards;
+  if (board.player == Player::white) {
+    expand_shards<Player::white>(board, split_ply, depth - split_ply, index,
+                                 shards);
+  } else {
+    expand_shards<Player::black>(board, split_ply, depth - split_ply, index,
+                                 shards);
+  }
+  return shards;
+}
+
+// Hands shards to worker processes that connect over TCP. Each worker is
+// sent "perft <depth> <fen>" and answers "nodes <count>"; "quit" ends it.
+// A shard whose worker disconnects, answers with anything else or does not
+// answer within the shard timeout goes back on the queue for the next free
+// worker.
+class ShardCoordinator {
+private:
+  std::vector<PerftShard> _shards;
+  std::deque<size_t> _pending;
+  size_t _remaining;
+  int _retries = 0;
+  int _timeout_ms;
+  std::mutex _mutex;
+  std::condition_variable _changed;
+
+  bool take(size_t &shard) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock,
+                  [this] { return !_pending.empty() || _remaining == 0; });
+    if (_remaining == 0) {
+      return false;
+    }
+    shard = _pending.front();
+    _pending.pop_front();
+    _shards[shard].attempts++;
+    return true;
+  }
+
+  void finish(size_t shard, uint64_t nodes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shards[shard].nodes = nodes;
+    if (--_remaining == 0) {
+      _changed.notify_all();
+    }
+  }
+
+  void retry(size_t shard) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.push_front(shard);
+    _retries++;
+    _changed.notify_one();
+  }
+
+  void serve(Socket worker, int id) {
+    // A worker that hangs without closing its socket times out and is
+    // dropped like one that disconnected.
+    worker.set_receive_timeout(_timeout_ms);
+    size_t shard;
+    while (take(shard)) {
+      const PerftShard &job = _shards[shard];
+      std::string reply;
+      std::istringstream fields;
+      std::string word;
+      uint64_t nodes = 0ull;
+      bool answered =
+          worker.send_line("perft " + std::to_string(job.depth) + ' ' +
+                           job.fen) &&
+          worker.receive_line(reply);
+      if (answered) {
+        fields.str(reply);
+        answered = (fields >> word >> nodes) && word == "nodes";
+      }
+      if (!answered) {
+        std::cout << "Worker " << id << " lost, requeueing " << job.fen
+                  << std::endl;
+        retry(shard);
+        return;
+      }
+      finish(shard, nodes);
+    }
+    worker.send_line("quit");
+  }
+
+public:
+  ShardCoordinator(std::vector<PerftShard> shards, int timeout_ms)
+      : _shards(std::move(shards)), _remaining(_shards.size()),
+        _timeout_ms(timeout_ms) {
+    for (size_t i = 0; i < _shards.size(); ++i) {
+      _pending.push_back(i);
+    }
+  }
+
+  // Accept workers on listener until every shard has been counted.
+  void run(Socket &listener) {
+    std::vector<std::thread> connections;
+    int next_id = 0;
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_remaining == 0) {
+          break;
+        }
+      }
+      Socket worker = listener.accept(100);
+      if (worker.is_valid()) {
+        std::cout << "Worker " << next_id << " connected." << std::endl;
+        connections.emplace_back(&ShardCoordinator::serve, this,
+                                 std::move(worker), next_id++);
+      }
+    }
+    for (auto &connection : connections) {
+      connection.join();
+    }
+  }
+
+  uint64_t nodes() const {
+    uint64_t nodes = 0ull;
+    for (const auto &shard : _shards) {
+      nodes += shard.nodes * shard.paths;
+    }
+    return nodes;
+  }
+
+  size_t size() const { return _shards.size(); }
+  int retries() const { return _retries; }
+};
+
+// Count fen to depth on worker processes. When local_workers is non-zero
+// that many workers are started on this machine from program, splitting the
+// hardware threads between them. A worker that takes longer than
+// timeout_seconds to answer a shard is dropped and the shard retried, so the
+// timeout must be longer than the slowest shard; zero never times out.
+inline void perft_coordinator(const std::string &fen, int depth, uint16_t port,
+                              int split_ply, unsigned local_workers,
+                              const std::string &program,
+                              int timeout_seconds = 600) {
+  if (depth < 1) {
+    std::cout << "Sharded perft depth must be at least 1." << std::endl;
+    return;
+  }
+
+  Socket listener = Socket::listen(port);
+  if (!listener.is_valid()) {
+    std::cout << "Could not listen on port " << port << '.' << std::endl;
+    return;
+  }
+
+  Clock clock;
+  ShardCoordinator coordinator(create_shards(fen, depth, split_ply),
+                              timeout_seconds * 1000);
+  std::cout << "Split into " << coordinator.size() << " shards, listening on "
+            << port << std::endl;
+
+  std::vector<std::thread> processes;
+  unsigned threads =
+      std::max(default_thread_count() / std::max(local_workers, 1u), 1u);
+  for (unsigned i = 0; i < local_workers; ++i) {
+    std::string command = '"' + program + "\" worker 127.0.0.1 " +
+                          std::to_string(port) + ' ' + std::to_string(threads);
+    processes.emplace_back([command] { std::system(command.c_str()); });
+  }
+
+  coordinator.run(listener);
+  listener.close();
+  for (auto &process : processes) {
+    process.join();
+  }
+
+  long long milliseconds = clock.elapsed();
+  std::cout << "\nNodes searched: " << coordinator.nodes() << " in "
+            << milliseconds << "ms";
+  if (milliseconds > 0) {
+    std::cout << " (" << std::fixed << std::setprecision(2)
+              << coordinator.nodes() / (milliseconds / 1000.0) / 1000000
+              << "M n/s)";
+  }
+  std::cout << "\nShards: " << coordinator.size()
+            << " retried: " << coordinator.retries() << std::endl;
+}
+
+// Connect to a coordinator and count the shards it sends until told to quit.
+inline void perft_worker(const std::string &host, uint16_t port,
+                         unsigned threads, size_t hash_megabytes) {
+  Socket coordinator;
+  for (int attempt = 0; attempt < 50 && !coordinator.is_valid(); ++attempt) {
+    coordinator = Socket::connect(host, port);
+    if (!coordinator.is_valid()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+  if (!coordinator.is_valid()) {
+    std::cout << "Could not connect to " << host << ':' << port << '.'
+              << std::endl;
+    return;
+  }
+
+  std::unique_ptr<PerftHash> table;
+  if (hash_megabytes > 0) {
+    table = std::make_unique<PerftHash>(hash_megabytes);
+  }
+  ParallelPerft parallel_perft(threads, table.get());
+
+  std::string line;
+  while (coordinator.receive_line(line)) {
+    std::istringstream fields(line);
+    std::string word;
+    int depth;
+    if (!(fields >> word >> depth) || word != "perft") {
+      break;
+    }
+    std::string fen;
+    std::getline(fields >> std::ws, fen);
+    Board board = fen::create_board(fen);
+    uint64_t nodes = parallel_perft(board, depth).nodes;
+    if (!coordinator.send_line("nodes " + std::to_string(nodes))) {
+      break;
+    }
+  }
+}
+
+#endif
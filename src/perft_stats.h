@@ -0,0 +1,89 @@
+#ifndef PERFT_STATS_H
+#define PERFT_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "fen.h"
+#include "move.h"
+#include "move_list.h"
+#include "perft.h"
+#include "perft_test.h"
+
+// Split the root moves between threads, each counting into a PerftStats on
+// its own stack, and merge the counters once every thread has finished.
+template <Player Stm>
+inline PerftStats collect_stats(const Board &board, int depth,
+                                unsigned threads) {
+  Board root = board;
+  std::vector<Move> moves;
+  MoveList<Stm> move_list(root);
+  if (depth == 1) {
+    PerftStats stats;
+    count_leaf_stats<Stm>(root, move_list, stats);
+    return stats;
+  }
+  for (Move move = move_list.get_move(); move != null_move;
+       move = move_list.get_move()) {
+    moves.push_back(move);
+  }
+
+  std::atomic<size_t> next{0};
+  std::vector<PerftStats> thread_stats(std::max(threads, 1u));
+  std::vector<std::thread> workers;
+  for (auto &thread_total : thread_stats) {
+    workers.emplace_back([&board, &moves, &next, &thread_total, depth] {
+      Board local = board;
+      PerftStats stats;
+      for (size_t i = next++; i < moves.size(); i = next++) {
+        local.make_move<Stm>(moves[i]);
+        perft<!Stm>(local, depth - 1, StatsCount{&stats});
+        local.unmake_move<Stm>(moves[i]);
+      }
+      thread_total = stats;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  PerftStats total;
+  for (const auto &stats : thread_stats) {
+    total += stats;
+  }
+  return total;
+}
+
+// Print the per category breakdown for every depth up to depth.
+inline void perft_stats(const std::string &fen, int depth, unsigned threads) {
+  Board board = fen::create_board(fen);
+  std::cout << std::left << std::setw(6) << "depth" << std::right
+            << std::setw(16) << "nodes" << std::setw(14) << "captures"
+            << std::setw(10) << "e.p." << std::setw(12) << "castles"
+            << std::setw(12) << "promotions" << std::setw(12) << "checks"
+            << std::setw(12) << "disc checks" << std::setw(12) << "dbl checks"
+            << std::setw(12) << "checkmates" << std::setw(10) << "ms" << '\n';
+  for (int d = 1; d <= depth; ++d) {
+    Clock clock;
+    PerftStats stats =
+        board.player == Player::white
+            ? collect_stats<Player::white>(board, d, threads)
+            : collect_stats<Player::black>(board, d, threads);
+    std::cout << std::left << std::setw(6) << d << std::right << std::setw(16)
+              << stats.nodes << std::setw(14) << stats.captures
+              << std::setw(10) << stats.en_passants << std::setw(12)
+              << stats.castles << std::setw(12) << stats.promotions
+              << std::setw(12) << stats.checks << std::setw(12)
+              << stats.discovery_checks << std::setw(12) << stats.double_checks
+              << std::setw(12) << stats.checkmates << std::setw(10)
+              << clock.elapsed() << std::endl;
+  }
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PERFT_TEST_H
+#define PERFT_TEST_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+class Clock {
+private:
+  std::chrono::time_point<std::chrono::steady_clock> _then;
+
+public:
+  Clock() noexcept : _then(std::chrono::steady_clock::now()) {}
+  long long elapsed() const noexcept {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - _then)
+        .count();
+  }
+  long long elapsed_microseconds() const noexcept {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now - _then)
+        .count();
+  }
+  long long elapsed_nanoseconds() const noexcept {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now - _then)
+        .count();
+  }
+};
+
+class PerftTest {
+private:
+  std::string _fen;
+  uint64_t _nodes_expected;
+  uint64_t _nodes;
+  int _depth;
+  long long _milliseconds;
+
+public:
+  PerftTest()
+      : _nodes_expected(0ull), _nodes(0ull), _depth(0), _milliseconds(0) {}
+
+  PerftTest(const std::string &fen, int depth, uint64_t nodes_expected)
+      : PerftTest() {
+    _fen = fen;
+    _depth = depth;
+    _nodes_expected = nodes_expected;
+  }
+
+  const std::string &get_fen() const { return _fen; }
+
+  int get_depth() const { return _depth; }
+
+  uint64_t get_nodes() const { return _nodes; }
+
+  uint64_t get_nodes_expected() const { return _nodes_expected; }
+
+  long long get_milliseconds() const { return _milliseconds; }
+
+  void set_nodes(uint64_t nodes) { _nodes = nodes; }
+
+  void set_milliseconds(long long milliseconds) {
+    _milliseconds = milliseconds;
+  }
+
+  bool passed() const { return _nodes_expected == _nodes; }
+};
+
+#endif
@@ -20,10 +20,6 @@ struct PlayerTraits<Player::white>
     static constexpr int right = 7;
     static constexpr uint64_t double_mask = 0x0000000000ff0000;
     static constexpr uint64_t promotion_mask = 0xff00000000000000;
-    static uint64_t pawn_left(uint64_t pawns) noexcept
-    {
-
-    }
 };
 
 template<> struct PlayerTraits<Player::black>
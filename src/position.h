@@ -0,0 +1,143 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "bitboard.h"
+#include "board.h"
+#include "move.h"
+#include "piece.h"
+#include "player.h"
+
+// The bitboards of a Board without its mailbox, Zobrist key, clocks or
+// unmake stack, in 80 trivially copyable bytes. It has the accessors MoveList
+// reads, so moves can be generated for it, and make_move only updates the
+// bitboards, en passant square and castle rights. There is no unmake_move: a
+// move is made on a copy and the position before it is left as it was. Perft
+// uses it at the frontier and for copy-make, neither of which hashes.
+struct Position {
+  std::array<uint64_t, Piece::count> pieces;
+  std::array<uint64_t, 2> occupancy;
+  int en_passant;
+  unsigned castle_rights;
+
+  Position() = default;
+
+  explicit Position(const Board &board)
+      : pieces(board.pieces), occupancy(board.occupancy),
+        en_passant(board.en_passant), castle_rights(board.castle_rights) {}
+
+  template <Piece... P> constexpr uint64_t get_piece_mask() const noexcept {
+    return (std::get<P>(pieces) | ...);
+  }
+
+  template <Player Stm, Piece... P>
+  constexpr uint64_t get_piece_mask() const noexcept {
+    return std::get<static_cast<int>(Stm)>(occupancy) & get_piece_mask<P...>();
+  }
+
+  template <Player Stm> uint64_t get_occupied_mask() const noexcept {
+    return std::get<static_cast<int>(Stm)>(occupancy);
+  }
+
+  uint64_t get_occupied_mask() const noexcept {
+    return occupancy[0] | occupancy[1];
+  }
+
+  template <Player Stm> int get_king_square() const {
+    return bitboard::get_lsb(get_piece_mask<Stm, Piece::king>());
+  }
+
+  // Without a mailbox the piece is found by testing the piece masks. The
+  // generator only asks for the pieces pinned to the king.
+  Piece get_piece(int square) const {
+    const uint64_t square_mask = bitboard::to_bitboard(square);
+    if (!(get_occupied_mask() & square_mask)) {
+      return Piece::none;
+    }
+    for (int piece = Piece::pawn; piece < Piece::king; ++piece) {
+      if (pieces[piece] & square_mask) {
+        return static_cast<Piece>(piece);
+      }
+    }
+    return Piece::king;
+  }
+
+  template <Player Stm> bool can_castle_kingside(uint64_t attack_mask) const {
+    constexpr unsigned rights =
+        Stm == Player::white ? kingside_castle_white : kingside_castle_black;
+    const int king_square = get_king_square<Stm>();
+    const uint64_t path =
+        bitboard::between_horizonal(king_square, king_square - 3);
+    return (castle_rights & rights) != 0u &&
+           !(path & (get_occupied_mask() | attack_mask));
+  }
+
+  template <Player Stm> bool can_castle_queenside(uint64_t attack_mask) const {
+    constexpr unsigned rights =
+        Stm == Player::white ? queenside_castle_white : queenside_castle_black;
+    const int king_square = get_king_square<Stm>();
+    return (castle_rights & rights) != 0u &&
+           !(bitboard::between_horizonal(king_square, king_square + 4) &
+             get_occupied_mask()) &&
+           !(bitboard::between_horizonal(king_square, king_square + 3) &
+             attack_mask);
+  }
+
+  // Play a legal move of Stm, following Board::make_move.
+  template <Player Stm> void make_move(Move move) {
+    constexpr int own = static_cast<int>(Stm);
+    constexpr int enemy = static_cast<int>(!Stm);
+    const int from = move.from();
+    const int to = move.to();
+    const uint64_t from_mask = bitboard::to_bitboard(from);
+    const uint64_t to_mask = bitboard::to_bitboard(to);
+    const Piece moved = get_piece(from);
+    const Piece captured = get_piece(to);
+
+    if (captured != Piece::none) {
+      pieces[captured] ^= to_mask;
+      occupancy[enemy] ^= to_mask;
+    }
+    pieces[moved] ^= from_mask | to_mask;
+    occupancy[own] ^= from_mask | to_mask;
+    en_passant = 0;
+
+    switch (move.type()) {
+    case MoveType::normal:
+      break;
+    case MoveType::double_push:
+      en_passant = (from + to) / 2;
+      break;
+    case MoveType::en_passant: {
+      const uint64_t capture_mask =
+          bitboard::to_bitboard(to - PlayerTraits<Stm>::forward);
+      pieces[Piece::pawn] ^= capture_mask;
+      occupancy[enemy] ^= capture_mask;
+      break;
+    }
+    case MoveType::castle: {
+      // The rook jumps from the corner to the square the king crossed.
+      const uint64_t rook_mask = from > to
+                                     ? bitboard::to_bitboard(to - 1, to + 1)
+                                     : bitboard::to_bitboard(to + 2, to - 1);
+      pieces[Piece::rook] ^= rook_mask;
+      occupancy[own] ^= rook_mask;
+      break;
+    }
+    default: // Promotions.
+      pieces[Piece::pawn] ^= to_mask;
+      pieces[move.promotion()] ^= to_mask;
+      break;
+    }
+
+    castle_rights &= castle_rights_mask[from] & castle_rights_mask[to];
+  }
+};
+
+static_assert(std::is_trivially_copyable<Position>::value,
+              "Copy-make relies on a Position copying as plain bytes.");
+
+#endif
@@ -0,0 +1,310 @@
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+#include "slider_attacks.h"
+
+SliderBackend slider_backend = SliderBackend::magic;
+
+CompactTable compact_bishop_tables[64];
+CompactTable compact_rook_tables[64];
+CompactTable compact_pext_bishop_tables[64];
+CompactTable compact_pext_rook_tables[64];
+
+static bool pext_supported = false;
+
+// Distinct attack sets of each square, shared by both compact index kinds.
+static std::vector<uint64_t> compact_bishop_attacks_db;
+static std::vector<uint64_t> compact_rook_attacks_db;
+static std::vector<uint8_t> compact_bishop_index_db;
+static std::vector<uint8_t> compact_rook_index_db;
+static std::vector<uint8_t> compact_pext_bishop_index_db;
+static std::vector<uint8_t> compact_pext_rook_index_db;
+
+// Scatter the low bits of index over the set bits of mask, the inverse of
+// PEXT, so the tables can be filled without BMI2.
+static uint64_t deposit(uint64_t index, uint64_t mask) {
+  uint64_t occupancy = 0ull;
+  while (mask) {
+    uint64_t bit = mask & (0ull - mask);
+    if (index & 1ull) {
+      occupancy |= bit;
+    }
+    index >>= 1;
+    mask ^= bit;
+  }
+  return occupancy;
+}
+
+static constexpr int bit_count(uint64_t bits) {
+  int count = 0;
+  for (; bits; bits &= bits - 1) {
+    ++count;
+  }
+  return count;
+}
+
+// The occupancy that matters to a slider: its empty board rays without the
+// last square of each, the same masks as magic_moves.h uses.
+static constexpr uint64_t relevant_mask(int square,
+                                        const int (&directions)[4][2]) {
+  uint64_t mask = 0ull;
+  for (const auto &direction : directions) {
+    int rank = square / 8 + direction[0];
+    int file = square % 8 + direction[1];
+    while (rank + direction[0] >= 0 && rank + direction[0] < 8 &&
+           file + direction[1] >= 0 && file + direction[1] < 8) {
+      mask |= 1ull << (rank * 8 + file);
+      rank += direction[0];
+      file += direction[1];
+    }
+  }
+  return mask;
+}
+
+static constexpr const int (&slider_directions(bool rook))[4][2] {
+  return rook ? bitboard::rook_directions : bitboard::bishop_directions;
+}
+
+static constexpr int pext_entries(bool rook, int square) {
+  return 1 << bit_count(relevant_mask(square, slider_directions(rook)));
+}
+
+static constexpr int pext_entries(bool rook) {
+  int entries = 0;
+  for (int square = 0; square < 64; ++square) {
+    entries += pext_entries(rook, square);
+  }
+  return entries;
+}
+
+template <int Size> struct PextAttacks {
+  uint64_t attacks[Size];
+};
+
+// The attacks of one square in PEXT order. Walking the subsets of the mask
+// with the carry-rippler trick visits them in the same order as PDEP of a
+// counter. Every square is a constant expression of its own, which keeps
+// each below the compilers' constexpr step limits.
+template <bool Rook, int Square>
+static constexpr PextAttacks<pext_entries(Rook, Square)> create_pext_square() {
+  const uint64_t mask = relevant_mask(Square, slider_directions(Rook));
+  PextAttacks<pext_entries(Rook, Square)> square{};
+  uint64_t occupancy = 0ull;
+  int index = 0;
+  do {
+    square.attacks[index++] =
+        bitboard::sliding_attacks(Square, occupancy, slider_directions(Rook));
+    occupancy = (occupancy - mask) & mask;
+  } while (occupancy);
+  return square;
+}
+
+template <bool Rook, int Square>
+static constexpr PextAttacks<pext_entries(Rook, Square)> pext_square_attacks =
+    create_pext_square<Rook, Square>();
+
+template <int Size, int SquareSize>
+static constexpr int copy_attacks(PextAttacks<Size> &attacks, int offset,
+                                  const PextAttacks<SquareSize> &square) {
+  for (int index = 0; index < SquareSize; ++index) {
+    attacks.attacks[offset + index] = square.attacks[index];
+  }
+  return offset + SquareSize;
+}
+
+template <bool Rook, int... Squares>
+static constexpr PextAttacks<pext_entries(Rook)>
+create_pext_attacks(std::integer_sequence<int, Squares...>) {
+  PextAttacks<pext_entries(Rook)> attacks{};
+  int offset = 0;
+  ((offset = copy_attacks(attacks, offset, pext_square_attacks<Rook, Squares>)),
+   ...);
+  return attacks;
+}
+
+static constexpr std::array<PextTable, 64>
+create_pext_tables(bool rook, const uint64_t *attacks) {
+  std::array<PextTable, 64> tables{};
+  for (int square = 0; square < 64; ++square) {
+    tables[square] = {attacks, relevant_mask(square, slider_directions(rook))};
+    attacks += pext_entries(rook, square);
+  }
+  return tables;
+}
+
+// The PEXT tables are generated at compile time like the magic databases,
+// so they cost nothing at startup on hosts that do not use them.
+static constexpr PextAttacks<pext_entries(false)> pext_bishop_attacks_db =
+    create_pext_attacks<false>(std::make_integer_sequence<int, 64>{});
+static constexpr PextAttacks<pext_entries(true)> pext_rook_attacks_db =
+    create_pext_attacks<true>(std::make_integer_sequence<int, 64>{});
+
+constexpr std::array<PextTable, 64> pext_bishop_tables =
+    create_pext_tables(false, pext_bishop_attacks_db.attacks);
+constexpr std::array<PextTable, 64> pext_rook_tables =
+    create_pext_tables(true, pext_rook_attacks_db.attacks);
+
+// Number of entries the magic hash of a square can produce.
+static size_t magic_entries(const unsigned shifts[64], int square) {
+  return size_t{1} << (64 - shifts[square]);
+}
+
+// Give every distinct attack set of a square a one byte id, found through a
+// hash map so the build is linear in the number of entries, and write the
+// id for every index of the magic hash and, when with_pext, of PEXT.
+template <class Lookup>
+static void fill_compact_tables(CompactTable magic_tables[64],
+                                CompactTable pext_tables[64],
+                                const U64 masks[64], const U64 magics[64],
+                                const unsigned shifts[64],
+                                std::vector<uint64_t> &attacks_db,
+                                std::vector<uint8_t> &magic_index_db,
+                                std::vector<uint8_t> &pext_index_db,
+                                bool with_pext, Lookup lookup) {
+  size_t magic_size = 0;
+  size_t pext_size = 0;
+  for (int square = 0; square < 64; ++square) {
+    magic_size += magic_entries(shifts, square);
+    pext_size += size_t{1} << bitboard::pop_count(masks[square]);
+  }
+  magic_index_db.assign(magic_size, 0);
+  pext_index_db.assign(with_pext ? pext_size : 0, 0);
+  attacks_db.clear();
+
+  std::array<size_t, 64> attacks_offsets;
+  size_t magic_offset = 0;
+  size_t pext_offset = 0;
+  std::unordered_map<uint64_t, uint8_t> ids;
+  for (int square = 0; square < 64; ++square) {
+    attacks_offsets[square] = attacks_db.size();
+    ids.clear();
+    const uint64_t entries = 1ull << bitboard::pop_count(masks[square]);
+    for (uint64_t index = 0; index < entries; ++index) {
+      const uint64_t occupancy = deposit(index, masks[square]);
+      const uint64_t attacks =
+          lookup(static_cast<unsigned int>(square), occupancy);
+      auto id = ids.emplace(attacks, static_cast<uint8_t>(ids.size()));
+      if (id.second) {
+        attacks_db.push_back(attacks);
+      }
+      magic_index_db[magic_offset +
+                     ((occupancy * magics[square]) >> shifts[square])] =
+          id.first->second;
+      if (with_pext) {
+        pext_index_db[pext_offset + index] = id.first->second;
+      }
+    }
+    magic_tables[square] = {magic_index_db.data() + magic_offset, nullptr,
+                            masks[square], magics[square], shifts[square]};
+    pext_tables[square] = {with_pext ? pext_index_db.data() + pext_offset
+                                     : nullptr,
+                           nullptr, masks[square], 0ull, 0u};
+    magic_offset += magic_entries(shifts, square);
+    pext_offset += entries;
+  }
+
+  // The attack lists only have their final address once all are added.
+  for (int square = 0; square < 64; ++square) {
+    magic_tables[square].attacks = attacks_db.data() + attacks_offsets[square];
+    pext_tables[square].attacks = attacks_db.data() + attacks_offsets[square];
+  }
+}
+
+// The compact tables are built from the magic databases the first time a
+// compact backend is used, so the other backends do not pay for them.
+static void create_compact_tables() {
+  static bool created = false;
+  if (created) {
+    return;
+  }
+  created = true;
+  fill_compact_tables(compact_bishop_tables, compact_pext_bishop_tables,
+                      magicmoves_b_mask, magicmoves_b_magics,
+                      magicmoves_b_shift, compact_bishop_attacks_db,
+                      compact_bishop_index_db, compact_pext_bishop_index_db,
+                      pext_supported,
+                      [](unsigned int square, uint64_t occupancy) {
+                        return Bmagic(square, occupancy);
+                      });
+  fill_compact_tables(compact_rook_tables, compact_pext_rook_tables,
+                      magicmoves_r_mask, magicmoves_r_magics,
+                      magicmoves_r_shift, compact_rook_attacks_db,
+                      compact_rook_index_db, compact_pext_rook_index_db,
+                      pext_supported,
+                      [](unsigned int square, uint64_t occupancy) {
+                        return Rmagic(square, occupancy);
+                      });
+}
+
+void slider_attacks_init() {
+  pext_supported = cpu_supports_pext();
+  slider_backend = pext_supported && cpu_supports_pext(true)
+                       ? SliderBackend::pext
+                       : SliderBackend::magic;
+}
+
+bool set_slider_backend(SliderBackend backend) {
+  if ((backend == SliderBackend::pext ||
+       backend == SliderBackend::compact_pext) &&
+      !pext_supported) {
+    return false;
+  }
+  if (backend == SliderBackend::compact ||
+      backend == SliderBackend::compact_pext) {
+    create_compact_tables();
+  }
+  slider_backend = backend;
+  return true;
+}
+
+size_t slider_table_bytes(SliderBackend backend) {
+  // Only the compact backends need their tables built to be measured.
+  if (backend == SliderBackend::compact ||
+      backend == SliderBackend::compact_pext) {
+    create_compact_tables();
+  }
+  const size_t compact_attacks_bytes =
+      (compact_bishop_attacks_db.size() + compact_rook_attacks_db.size()) *
+      sizeof(uint64_t);
+
+  switch (backend) {
+  case SliderBackend::pext:
+    return sizeof(pext_bishop_attacks_db) + sizeof(pext_rook_attacks_db) +
+           sizeof(pext_bishop_tables) + sizeof(pext_rook_tables);
+  case SliderBackend::compact:
+    return compact_bishop_index_db.size() + compact_rook_index_db.size() +
+           compact_attacks_bytes + sizeof(compact_bishop_tables) +
+           sizeof(compact_rook_tables);
+  case SliderBackend::compact_pext:
+    return compact_pext_bishop_index_db.size() +
+           compact_pext_rook_index_db.size() + compact_attacks_bytes +
+           sizeof(compact_pext_bishop_tables) +
+           sizeof(compact_pext_rook_tables);
+  default: {
+    size_t magic_size = 0;
+    for (int square = 0; square < 64; ++square) {
+      magic_size += magic_entries(magicmoves_b_shift, square) +
+                    magic_entries(magicmoves_r_shift, square);
+    }
+    // The attack sets plus the magics, masks, shifts and table pointers.
+    return magic_size * sizeof(U64) +
+           2 * 64 * (2 * sizeof(U64) + sizeof(unsigned) + sizeof(U64 *));
+  }
+  }
+}
+
+const char *to_string(SliderBackend backend) {
+  switch (backend) {
+  case SliderBackend::pext:
+    return "pext";
+  case SliderBackend::compact:
+    return "compact";
+  case SliderBackend::compact_pext:
+    return "compact-pext";
+  default:
+    return "magic";
+  }
+}
@@ -0,0 +1,134 @@
+#ifndef SLIDER_ATTACKS_H
+#define SLIDER_ATTACKS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_features.h"
+#include "magic_moves.h"
+
+// Slider attack lookups with a choice of index function and table layout.
+// The magic backend hashes the occupancy with the multiply-shift magics of
+// magic_moves.h. The PEXT backend gathers the relevant occupancy bits with
+// BMI2 into a dense index, removing the multiply and the shift load. Both
+// read one 8 byte attack set per index, which is about 800 KB of tables.
+//
+// The compact backends use the same index functions but store a one byte
+// index per entry into a per square list of the distinct attack sets, of
+// which there are at most 144 per square. That costs a second dependent
+// load and shrinks the tables to about 160 KB.
+//
+// The backend is chosen once at startup from CPUID, so the same binary runs
+// on hosts without BMI2.
+enum class SliderBackend { magic, pext, compact, compact_pext };
+
+constexpr std::array<SliderBackend, 4> slider_backends = {
+    SliderBackend::magic, SliderBackend::pext, SliderBackend::compact,
+    SliderBackend::compact_pext};
+
+extern SliderBackend slider_backend;
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SLIDER_PEXT_AVAILABLE 1
+#include <immintrin.h>
+// Without -mbmi2 the PEXT lookups are compiled for BMI2 on their own and
+// only called once CPUID has confirmed the instruction exists.
+#if defined(__BMI2__) || !defined(__GNUC__)
+#define PEXT_TARGET
+#else
+#define PEXT_TARGET __attribute__((target("bmi2")))
+#endif
+#else
+#define SLIDER_PEXT_AVAILABLE 0
+#endif
+
+struct PextTable {
+  const uint64_t *attacks;
+  uint64_t mask;
+};
+
+struct CompactTable {
+  const uint8_t *index;
+  const uint64_t *attacks;
+  uint64_t mask;
+  uint64_t magic;
+  unsigned shift;
+};
+
+extern const std::array<PextTable, 64> pext_bishop_tables;
+extern const std::array<PextTable, 64> pext_rook_tables;
+extern CompactTable compact_bishop_tables[64];
+extern CompactTable compact_rook_tables[64];
+extern CompactTable compact_pext_bishop_tables[64];
+extern CompactTable compact_pext_rook_tables[64];
+
+inline uint64_t compact_attacks(const CompactTable &table, uint64_t occupancy) {
+  return table.attacks
+      [table.index[((occupancy & table.mask) * table.magic) >> table.shift]];
+}
+
+#if SLIDER_PEXT_AVAILABLE
+PEXT_TARGET inline uint64_t pext_bishop_attacks(int square,
+                                                uint64_t occupancy) {
+  const PextTable &table = pext_bishop_tables[square];
+  return table.attacks[_pext_u64(occupancy, table.mask)];
+}
+
+PEXT_TARGET inline uint64_t pext_rook_attacks(int square, uint64_t occupancy) {
+  const PextTable &table = pext_rook_tables[square];
+  return table.attacks[_pext_u64(occupancy, table.mask)];
+}
+
+PEXT_TARGET inline uint64_t compact_pext_attacks(const CompactTable &table,
+                                                 uint64_t occupancy) {
+  return table.attacks[table.index[_pext_u64(occupancy, table.mask)]];
+}
+#endif
+
+inline uint64_t bishop_lookup(int square, uint64_t occupancy) {
+  switch (slider_backend) {
+#if SLIDER_PEXT_AVAILABLE
+  case SliderBackend::pext:
+    return pext_bishop_attacks(square, occupancy);
+  case SliderBackend::compact_pext:
+    return compact_pext_attacks(compact_pext_bishop_tables[square], occupancy);
+#endif
+  case SliderBackend::compact:
+    return compact_attacks(compact_bishop_tables[square], occupancy);
+  default:
+    return Bmagic(static_cast<unsigned int>(square), occupancy);
+  }
+}
+
+inline uint64_t rook_lookup(int square, uint64_t occupancy) {
+  switch (slider_backend) {
+#if SLIDER_PEXT_AVAILABLE
+  case SliderBackend::pext:
+    return pext_rook_attacks(square, occupancy);
+  case SliderBackend::compact_pext:
+    return compact_pext_attacks(compact_pext_rook_tables[square], occupancy);
+#endif
+  case SliderBackend::compact:
+    return compact_attacks(compact_rook_tables[square], occupancy);
+  default:
+    return Rmagic(static_cast<unsigned int>(square), occupancy);
+  }
+}
+
+inline uint64_t queen_lookup(int square, uint64_t occupancy) {
+  return bishop_lookup(square, occupancy) | rook_lookup(square, occupancy);
+}
+
+// Pick the default backend from CPUID.
+void slider_attacks_init();
+
+// Returns false, leaving the backend unchanged, if it is not supported.
+bool set_slider_backend(SliderBackend backend);
+
+// Bytes of lookup tables the backend reads from.
+size_t slider_table_bytes(SliderBackend backend);
+
+const char *to_string(SliderBackend backend);
+
+#endif
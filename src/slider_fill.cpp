@@ -0,0 +1,95 @@
+#include "slider_fill.h"
+#include "bitboard.h"
+
+SliderRays slider_rays_scalar(uint64_t diagonal, uint64_t orthogonal,
+                              uint64_t occupancy) {
+  const uint64_t empty = ~occupancy;
+  SliderRays result;
+  result.rays[0] = ray_fill<0>(orthogonal, empty);
+  result.rays[1] = ray_fill<1>(orthogonal, empty);
+  result.rays[2] = ray_fill<2>(diagonal, empty);
+  result.rays[3] = ray_fill<3>(diagonal, empty);
+  result.rays[4] = ray_fill<4>(orthogonal, empty);
+  result.rays[5] = ray_fill<5>(orthogonal, empty);
+  result.rays[6] = ray_fill<6>(diagonal, empty);
+  result.rays[7] = ray_fill<7>(diagonal, empty);
+  result.attacks = result.rays[0] | result.rays[1] | result.rays[2] |
+                   result.rays[3] | result.rays[4] | result.rays[5] |
+                   result.rays[6] | result.rays[7];
+  return result;
+}
+
+#if SLIDER_AVX2_AVAILABLE
+AVX2_TARGET SliderRays slider_rays_avx2(uint64_t diagonal,
+                                        uint64_t orthogonal,
+                                        uint64_t occupancy) {
+  // Lanes in Ray order: north, west, north west, north east for the left
+  // shifts and south, east, south east, south west for the right shifts,
+  // which use the same shift counts.
+  const __m256i shift1 = _mm256_setr_epi64x(ray_shifts[0], ray_shifts[1],
+                                            ray_shifts[2], ray_shifts[3]);
+  const __m256i shift2 = _mm256_add_epi64(shift1, shift1);
+  const __m256i shift4 = _mm256_add_epi64(shift2, shift2);
+  const __m256i generators = _mm256_setr_epi64x(
+      static_cast<long long>(orthogonal), static_cast<long long>(orthogonal),
+      static_cast<long long>(diagonal), static_cast<long long>(diagonal));
+  const __m256i empty = _mm256_set1_epi64x(static_cast<long long>(~occupancy));
+  const __m256i left_wrap =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left_wraps));
+  const __m256i right_wrap =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right_wraps));
+
+  __m256i left = generators;
+  __m256i right = generators;
+  __m256i left_propagator = _mm256_and_si256(empty, left_wrap);
+  __m256i right_propagator = _mm256_and_si256(empty, right_wrap);
+
+  left = _mm256_or_si256(
+      left, _mm256_and_si256(left_propagator, _mm256_sllv_epi64(left, shift1)));
+  right = _mm256_or_si256(right, _mm256_and_si256(right_propagator,
+                                                  _mm256_srlv_epi64(right, shift1)));
+  left_propagator = _mm256_and_si256(left_propagator,
+                                     _mm256_sllv_epi64(left_propagator, shift1));
+  right_propagator = _mm256_and_si256(
+      right_propagator, _mm256_srlv_epi64(right_propagator, shift1));
+
+  left = _mm256_or_si256(
+      left, _mm256_and_si256(left_propagator, _mm256_sllv_epi64(left, shift2)));
+  right = _mm256_or_si256(right, _mm256_and_si256(right_propagator,
+                                                  _mm256_srlv_epi64(right, shift2)));
+  left_propagator = _mm256_and_si256(left_propagator,
+                                     _mm256_sllv_epi64(left_propagator, shift2));
+  right_propagator = _mm256_and_si256(
+      right_propagator, _mm256_srlv_epi64(right_propagator, shift2));
+
+  left = _mm256_or_si256(
+      left, _mm256_and_si256(left_propagator, _mm256_sllv_epi64(left, shift4)));
+  right = _mm256_or_si256(right, _mm256_and_si256(right_propagator,
+                                                  _mm256_srlv_epi64(right, shift4)));
+
+  left = _mm256_and_si256(_mm256_sllv_epi64(left, shift1), left_wrap);
+  right = _mm256_and_si256(_mm256_srlv_epi64(right, shift1), right_wrap);
+
+  SliderRays result;
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(result.rays), left);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(result.rays + 4), right);
+  __m256i all = _mm256_or_si256(left, right);
+  __m128i half = _mm_or_si128(_mm256_castsi256_si128(all),
+                              _mm256_extracti128_si256(all, 1));
+  result.attacks = static_cast<uint64_t>(
+      _mm_cvtsi128_si64(_mm_or_si128(half, _mm_unpackhi_epi64(half, half))));
+  return result;
+}
+#endif
+
+static const bool use_avx2 = cpu_supports_avx2();
+
+SliderRays slider_rays(uint64_t diagonal, uint64_t orthogonal,
+                       uint64_t occupancy) {
+#if SLIDER_AVX2_AVAILABLE
+  if (use_avx2) {
+    return slider_rays_avx2(diagonal, orthogonal, occupancy);
+  }
+#endif
+  return slider_rays_scalar(diagonal, orthogonal, occupancy);
+}
@@ -0,0 +1,121 @@
+#ifndef SLIDER_FILL_H
+#define SLIDER_FILL_H
+
+#include <cstdint>
+
+#include "bitboard.h"
+#include "slider_attacks.h"
+
+// Attacks of every slider of a side at once, with Kogge-Stone occluded fills
+// instead of one table lookup per piece. Each of the eight directions is a
+// fill of all sliders moving that way; the AVX2 kernel runs the four left
+// shifting directions in one vector and the four right shifting in another.
+//
+// Rays are indexed so the opposite of ray d is (d + 4) % 8.
+enum class Ray {
+  north,
+  west,
+  north_west,
+  north_east,
+  south,
+  east,
+  south_east,
+  south_west,
+  count
+};
+
+constexpr int ray_count = static_cast<int>(Ray::count);
+
+// Square 0 is h1, so a left shift by 1 moves towards the a-file and a piece
+// on the a-file wraps onto the h-file of the next rank. The wrap masks hold
+// the squares a shift in that direction may land on.
+inline constexpr int ray_shifts[ray_count / 2] = {8, 1, 9, 7};
+inline constexpr uint64_t left_wraps[ray_count / 2] = {
+    ~0ull, ~bitboard::h_file, ~bitboard::h_file, ~bitboard::a_file};
+inline constexpr uint64_t right_wraps[ray_count / 2] = {
+    ~0ull, ~bitboard::a_file, ~bitboard::a_file, ~bitboard::h_file};
+
+// One step of bits in the direction of Ray. Bits is uint64_t or any type
+// with the same shift and bitwise operators, such as the lanes of a batch.
+template <int Ray, class Bits> Bits ray_step(Bits bits) {
+  constexpr bool left = Ray < ray_count / 2;
+  constexpr int steps = ray_shifts[Ray % (ray_count / 2)];
+  if constexpr (left) {
+    return (bits << steps) & left_wraps[Ray % (ray_count / 2)];
+  } else {
+    return (bits >> steps) & right_wraps[Ray % (ray_count / 2)];
+  }
+}
+
+// Occluded fill of the generator in one direction, returning the squares it
+// attacks. The shift is a template argument so each direction compiles to
+// immediate shifts.
+template <int Ray, class Bits> Bits ray_fill(Bits generator, Bits empty) {
+  constexpr bool left = Ray < ray_count / 2;
+  constexpr int steps = ray_shifts[Ray % (ray_count / 2)];
+  constexpr uint64_t wrap = left ? left_wraps[Ray % (ray_count / 2)]
+                                 : right_wraps[Ray % (ray_count / 2)];
+  auto shift = [](Bits bits, int count) {
+    if constexpr (left) {
+      return bits << count;
+    } else {
+      return bits >> count;
+    }
+  };
+  Bits propagator = empty & wrap;
+  generator |= propagator & shift(generator, steps);
+  propagator &= shift(propagator, steps);
+  generator |= propagator & shift(generator, 2 * steps);
+  propagator &= shift(propagator, 2 * steps);
+  generator |= propagator & shift(generator, 4 * steps);
+  return shift(generator, steps) & wrap;
+}
+
+struct SliderRays {
+  // Union of all rays.
+  uint64_t attacks;
+  // Squares attacked in each direction, up to and including the first
+  // occupied square.
+  uint64_t rays[ray_count];
+};
+
+#if SLIDER_PEXT_AVAILABLE
+#define SLIDER_AVX2_AVAILABLE 1
+#if defined(__AVX2__) || !defined(__GNUC__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#else
+#define SLIDER_AVX2_AVAILABLE 0
+#endif
+
+SliderRays slider_rays_scalar(uint64_t diagonal, uint64_t orthogonal,
+                              uint64_t occupancy);
+
+#if SLIDER_AVX2_AVAILABLE
+AVX2_TARGET SliderRays slider_rays_avx2(uint64_t diagonal,
+                                        uint64_t orthogonal,
+                                        uint64_t occupancy);
+#endif
+
+// Rays of the diagonal (bishops, queens) and orthogonal (rooks, queens)
+// sliders, with the AVX2 kernel when the CPU has it.
+SliderRays slider_rays(uint64_t diagonal, uint64_t orthogonal,
+                       uint64_t occupancy);
+
+// Pieces of own that are the only piece between the king and a slider.
+// king_rays are the rays of the king moving as a queen, computed with the
+// same occupancy as slider_rays: a piece hit by a slider ray and by the king
+// ray in the opposite direction is pinned.
+inline uint64_t pinned_pieces(const SliderRays &slider_rays,
+                              const SliderRays &king_rays, uint64_t own) {
+  uint64_t pinned = 0ull;
+  for (int ray = 0; ray < ray_count; ++ray) {
+    pinned |= slider_rays.rays[ray] &
+              king_rays.rays[(ray + ray_count / 2) % ray_count];
+  }
+  return pinned & own;
+}
+
+#endif
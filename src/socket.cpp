@@ -0,0 +1,196 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "socket.h"
+
+namespace {
+#ifdef _WIN32
+// Winsock must be started before the first socket call in the process.
+struct WinsockInit {
+  WinsockInit() {
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+  }
+  ~WinsockInit() { WSACleanup(); }
+} winsock_init;
+
+void close_handle(uintptr_t handle) { closesocket(handle); }
+constexpr int no_signal = 0;
+#else
+void close_handle(int handle) { ::close(handle); }
+constexpr int no_signal = MSG_NOSIGNAL;
+#endif
+} // namespace
+
+#ifdef _WIN32
+const Socket::Handle Socket::invalid_handle = INVALID_SOCKET;
+#else
+const Socket::Handle Socket::invalid_handle = -1;
+#endif
+
+Socket::Socket() : _handle(invalid_handle) {}
+
+Socket::Socket(Socket &&other) noexcept
+    : _handle(other._handle), _buffer(std::move(other._buffer)) {
+  other._handle = invalid_handle;
+}
+
+Socket &Socket::operator=(Socket &&other) noexcept {
+  if (this != &other) {
+    close();
+    _handle = other._handle;
+    _buffer = std::move(other._buffer);
+    other._handle = invalid_handle;
+  }
+  return *this;
+}
+
+Socket::~Socket() { close(); }
+
+Socket Socket::connect(const std::string &host, uint16_t port) {
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo *addresses = nullptr;
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                  &addresses) != 0) {
+    return Socket();
+  }
+
+  Socket socket;
+  for (addrinfo *address = addresses; address != nullptr;
+       address = address->ai_next) {
+    Handle handle = ::socket(address->ai_family, address->ai_socktype,
+                             address->ai_protocol);
+    if (handle == invalid_handle) {
+      continue;
+    }
+    if (::connect(handle, address->ai_addr,
+                  static_cast<int>(address->ai_addrlen)) == 0) {
+      int enable = 1;
+      setsockopt(handle, IPPROTO_TCP, TCP_NODELAY,
+                 reinterpret_cast<const char *>(&enable), sizeof(enable));
+      socket = Socket(handle);
+      break;
+    }
+    close_handle(handle);
+  }
+  freeaddrinfo(addresses);
+  return socket;
+}
+
+Socket Socket::listen(uint16_t port) {
+  Handle handle = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (handle == invalid_handle) {
+    return Socket();
+  }
+  int enable = 1;
+  setsockopt(handle, SOL_SOCKET, SO_REUSEADDR,
+             reinterpret_cast<const char *>(&enable), sizeof(enable));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (::bind(handle, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(handle, SOMAXCONN) != 0) {
+    close_handle(handle);
+    return Socket();
+  }
+  return Socket(handle);
+}
+
+Socket Socket::accept(int timeout_ms) {
+  fd_set read_set;
+  FD_ZERO(&read_set);
+  FD_SET(_handle, &read_set);
+  timeval timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_usec = (timeout_ms % 1000) * 1000;
+  if (select(static_cast<int>(_handle) + 1, &read_set, nullptr, nullptr,
+             &timeout) <= 0) {
+    return Socket();
+  }
+
+  Handle handle = ::accept(_handle, nullptr, nullptr);
+  if (handle == invalid_handle) {
+    return Socket();
+  }
+  // Keepalive lets a blocked read notice a worker host that went away.
+  int enable = 1;
+  setsockopt(handle, SOL_SOCKET, SO_KEEPALIVE,
+             reinterpret_cast<const char *>(&enable), sizeof(enable));
+  setsockopt(handle, IPPROTO_TCP, TCP_NODELAY,
+             reinterpret_cast<const char *>(&enable), sizeof(enable));
+  return Socket(handle);
+}
+
+void Socket::set_receive_timeout(int timeout_ms) {
+#ifdef _WIN32
+  DWORD timeout = static_cast<DWORD>(timeout_ms);
+#else
+  timeval timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_usec = (timeout_ms % 1000) * 1000;
+#endif
+  setsockopt(_handle, SOL_SOCKET, SO_RCVTIMEO,
+             reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+}
+
+bool Socket::send_line(const std::string &line) {
+  std::string message = line + '\n';
+  size_t sent = 0;
+  while (sent < message.size()) {
+    auto count = ::send(_handle, message.data() + sent,
+                        static_cast<int>(message.size() - sent), no_signal);
+    if (count <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+bool Socket::receive_line(std::string &line) {
+  while (true) {
+    size_t end = _buffer.find('\n');
+    if (end != std::string::npos) {
+      line = _buffer.substr(0, end);
+      _buffer.erase(0, end + 1);
+      return true;
+    }
+    char chunk[4096];
+    auto count = ::recv(_handle, chunk, sizeof(chunk), 0);
+    if (count <= 0) {
+      return false;
+    }
+    _buffer.append(chunk, static_cast<size_t>(count));
+  }
+}
+
+void Socket::close() {
+  if (_handle != invalid_handle) {
+    close_handle(_handle);
+    _handle = invalid_handle;
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <cstdint>
+#include <string>
+
+// Minimal blocking TCP socket used to hand perft shards between processes.
+// Messages are newline terminated lines of text.
+class Socket {
+private:
+#ifdef _WIN32
+  using Handle = uintptr_t;
+#else
+  using Handle = int;
+#endif
+  static const Handle invalid_handle;
+
+  Handle _handle;
+  std::string _buffer;
+
+  explicit Socket(Handle handle) : _handle(handle) {}
+
+public:
+  Socket();
+  Socket(const Socket &) = delete;
+  Socket &operator=(const Socket &) = delete;
+  Socket(Socket &&other) noexcept;
+  Socket &operator=(Socket &&other) noexcept;
+  ~Socket();
+
+  static Socket connect(const std::string &host, uint16_t port);
+  static Socket listen(uint16_t port);
+
+  bool is_valid() const { return _handle != invalid_handle; }
+  // Wait up to timeout_ms for a connection, returning an invalid socket if
+  // none arrives.
+  Socket accept(int timeout_ms);
+  // Make receive_line fail, as if the peer had disconnected, when nothing
+  // arrives for timeout_ms. Zero waits forever.
+  void set_receive_timeout(int timeout_ms);
+  bool send_line(const std::string &line);
+  bool receive_line(std::string &line);
+  void close();
+};
+
+#endif